@@ -143,6 +143,11 @@ ERRDEF(XLUNDEF,	"undefined label " LUA_QS)
 ERRDEF(XLDUP,	"duplicate label " LUA_QS)
 ERRDEF(XGSCOPE,	"<goto %s> jumps into the scope of local " LUA_QS)
 
+ERRDEF(XLEFTCOMPOUND,	"syntax error in left hand expression in compound assignment")
+ERRDEF(XRIGHTCOMPOUND,	"syntax error in right hand expression in compound assignment")
+ERRDEF(XNOTASSIGNABLE,	"syntax error expression not assignable")
+ERRDEF(XCONTINUE,	"no loop to continue")
+
 /* Bytecode reader errors. */
 ERRDEF(BCFMT,	"cannot load incompatible bytecode")
 ERRDEF(BCBAD,	"cannot load malformed bytecode")
@@ -1,15 +1,179 @@
 #include <Framework/Script/Basic.hpp>
 
+#include <Framework/Script/VariableType.hpp>
+
 extern "C" {
 #include <lauxlib.h>
+#include <lualib.h>
 }
 
+#include <algorithm>
+#include <cctype>
 #include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
 #include <cxxabi.h>
 
 namespace Script
 {
 
+namespace
+{
+
+// Registry key of the weak-valued identity cache: object address -> userdata
+const char IdentityKey = 0;
+
+// Registry key of the engine's RuntimeCounters, a light userdata.
+const char CountersKey = 0;
+
+// Registry key of the per-class cast functions: TypeId -> function(pointer) return typed cdata end,
+// index 0 holds the factory creating them.
+const char CDataKey = 0;
+
+// Registry key of the engine's CDataTypes, a full userdata.
+const char CTypeKey = 0;
+
+// Registry key of the metatable inheritance declared through Engine::GetMetatable: metatable -> parent metatable
+const char ParentKey = 0;
+
+// Mirrors the GCcdata header LuaJIT puts in front of every cdata payload, its GC reference is
+// 64 bit wide on 64 bit targets (LJ_GC64, the default there). The layout is checked once per engine.
+struct CDataHeader
+{
+	std::conditional_t< sizeof(void*) == 8, uint64_t, uint32_t > next;
+	uint8_t marked;
+	uint8_t type;
+	uint16_t ctype;
+};
+
+// Class pointer ctypes of an engine and the metatables they forward to, indexed by ctype id.
+struct CDataTypes
+{
+	std::vector< TypeId > types = {};
+	std::vector< std::string > metatables = {};
+};
+
+auto GetCType(const void* payload) -> uint16_t
+{
+	return (static_cast< const CDataHeader* >(payload) - 1)->ctype;
+}
+
+auto CollectCDataTypes(lua_State* L) -> int32_t
+{
+	static_cast< CDataTypes* >(lua_touserdata(L, 1))->~CDataTypes();
+	return 0;
+}
+
+// Every class gets a pointer ctype of its own, its id is remembered with the TypeId so cdata are checked
+// before their payload is read. ffi.metatype freezes its table, so the metatype forwards every access to
+// the live metatable, which is looked up on first use and may gain fields and metamethods later.
+// Only base library functions are used, engines may be created without package or string.
+// Returns the factory and a void* cdata with its ctype id, to check the header layout against.
+constexpr std::string_view CDataFactory = R"(
+	local ffi, FindMetatable = ...;
+	local typeof, cast, tonumber, tostring, rawget, type, error, ipairs = ffi.typeof, ffi.cast, tonumber, tostring, rawget, type, error, ipairs;
+	local Metamethods = { "__add", "__sub", "__mul", "__div", "__mod", "__pow", "__unm", "__concat", "__len", "__lt", "__le", "__call" };
+
+	local function Create(ctype, name)
+		ffi.cdef(ctype .. ";");
+
+		-- Registered metatables are found right away, deferred ones on first use.
+		local live = FindMetatable(name);
+		local function Lookup(key)
+			live = live or FindMetatable(name);
+			return live and rawget(live, key);
+		end
+
+		local metatype = {
+			__index = function(self, key)
+				local index = live and rawget(live, "__index") or Lookup("__index");
+				if type(index) == "function" then
+					return index(self, key);
+				elseif index ~= nil then
+					return index[key];
+				end
+				error("attempt to index '" .. name .. "' object with '" .. tostring(key) .. "'", 2);
+			end,
+			__newindex = function(self, key, value)
+				local newindex = live and rawget(live, "__newindex") or Lookup("__newindex");
+				if type(newindex) == "function" then
+					return newindex(self, key, value);
+				elseif newindex ~= nil then
+					newindex[key] = value;
+					return;
+				end
+				error("attempt to assign '" .. tostring(key) .. "' of '" .. name .. "' object", 2);
+			end,
+			__eq = function(left, right)
+				local eq = Lookup("__eq");
+				return eq ~= nil and eq(left, right);
+			end,
+			__tostring = function(self)
+				local tostringEvent = Lookup("__tostring");
+				return tostringEvent and tostringEvent(self) or "cdata<" .. ctype .. " *>";
+			end,
+		};
+		for _, event in ipairs(Metamethods) do
+			metatype[event] = function(...)
+				local handler = Lookup(event);
+				if handler == nil then
+					error("attempt to perform '" .. event .. "' on '" .. name .. "' object", 2);
+				end
+				return handler(...);
+			end;
+		end
+		ffi.metatype(ctype, metatype);
+
+		local pointerType = typeof(ctype .. "*");
+		return function(pointer)
+			return cast(pointerType, pointer);
+		end, tonumber(pointerType);
+	end
+
+	local probe = typeof("void *");
+	return Create, cast(probe, nil), tonumber(probe);
+)";
+
+auto FindMetatable(lua_State* L) -> int32_t
+{
+	luaL_getmetatable(L, luaL_checkstring(L, 1));
+	return 1;
+}
+
+// The package library may not be opened, so ffi is fetched from package.loaded or opened once and stored there.
+void PushFfi(lua_State* L)
+{
+	lua_getfield(L, LUA_REGISTRYINDEX, "_LOADED");
+	lua_getfield(L, -1, LUA_FFILIBNAME);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		lua_pushcfunction(L, luaopen_ffi);
+		lua_call(L, 0, 1);
+		lua_pushvalue(L, -1);
+		lua_setfield(L, -3, LUA_FFILIBNAME);
+	}
+	lua_remove(L, -2);
+}
+
+// Finalizer of an unreachable userdata, every collection cycle finalizes one and leaves a new one behind.
+auto CountCycle(lua_State* L) -> int32_t
+{
+	RuntimeCounters* counters = static_cast< RuntimeCounters* >(lua_touserdata(L, lua_upvalueindex(1)));
+	if (counters->closing) {
+		return 0;
+	}
+
+	counters->gcCycles++;
+	lua_newuserdata(L, 0);
+	lua_getmetatable(L, 1);
+	lua_setmetatable(L, -2);
+	lua_pop(L, 1);
+	return 0;
+}
+
+} // namespace
+
 auto ReplaceAll(std::string str, const std::string& fromStr, const std::string& toStr) -> std::string
 {
 	size_t startPos = size_t{};
@@ -22,21 +186,16 @@ auto ReplaceAll(std::string str, const std::string& fromStr, const std::string&
 
 auto Utils::DemangleClassName(const std::string& name) -> std::string
 {
-	constexpr size_t bufferSize = 1024;
-	static std::vector< char > buffer(bufferSize);
-	size_t len = 0;
+	// No shared buffer, engines may be created on background threads.
 	int status = 0;
-	char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, &len, &status);
-
-	if (demangled) {
-		strncpy(buffer.data(), demangled, bufferSize - 1);
-		buffer[ bufferSize - 1 ] = '\0';
-		std::free(demangled);
-	} else {
-		buffer[ 0 ] = '\0';
+	char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+	if (!demangled) {
+		return std::string{};
 	}
 
-	return ReplaceAll(buffer.data(), "::", "");
+	std::string result = demangled;
+	std::free(demangled);
+	return ReplaceAll(std::move(result), "::", "");
 }
 
 auto Utils::StringExplode(const std::string& string) -> std::vector< std::string >
@@ -113,4 +272,290 @@ void Utils::WeakRefGet(lua_State* L, const int referenceId)
 	lua_remove(L, -2);
 }
 
+void Utils::IdentityCacheCreate(lua_State* L, const bool enabled)
+{
+	lua_pushlightuserdata(L, const_cast< char* >(&IdentityKey));
+	if (enabled) {
+		if (IdentityCacheExists(L)) {
+			lua_pop(L, 1);
+			return;
+		}
+
+		lua_newtable(L);
+		lua_newtable(L);
+		lua_pushstring(L, "v");
+		lua_setfield(L, -2, "__mode");
+		lua_setmetatable(L, -2);
+	} else {
+		lua_pushnil(L);
+	}
+	lua_rawset(L, LUA_REGISTRYINDEX);
+}
+
+auto Utils::IdentityCacheExists(lua_State* L) -> bool
+{
+	lua_pushlightuserdata(L, const_cast< char* >(&IdentityKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	const bool exists = lua_istable(L, -1);
+	lua_pop(L, 1);
+	return exists;
+}
+
+auto Utils::IdentityCacheGet(lua_State* L, const void* pointer) -> bool
+{
+	lua_pushlightuserdata(L, const_cast< char* >(&IdentityKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+		return false;
+	}
+
+	lua_pushlightuserdata(L, const_cast< void* >(pointer));
+	lua_rawget(L, -2);
+	lua_remove(L, -2);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		return false;
+	}
+	return true;
+}
+
+void Utils::IdentityCacheSet(lua_State* L, const void* pointer)
+{
+	lua_pushlightuserdata(L, const_cast< char* >(&IdentityKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+		return;
+	}
+
+	lua_pushlightuserdata(L, const_cast< void* >(pointer));
+	lua_pushvalue(L, -3);
+	lua_rawset(L, -3);
+	lua_pop(L, 1);
+}
+
+void Utils::PushCData(lua_State* L, void* pointer, const std::string& metatable, const TypeId type)
+{
+	lua_pushlightuserdata(L, const_cast< char* >(&CDataKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+
+		if (luaL_loadbuffer(L, CDataFactory.data(), CDataFactory.size(), "=CDataFactory")) {
+			throw std::string{ "<Script::Utils::PushCData> " } + lua_tostring(L, -1);
+		}
+		PushFfi(L);
+		lua_pushcfunction(L, FindMetatable);
+		if (lua_pcall(L, 2, 3, 0)) {
+			throw std::string{ "<Script::Utils::PushCData> " } + lua_tostring(L, -1);
+		}
+
+		const bool layout = GetCType(lua_topointer(L, -2)) == static_cast< uint16_t >(lua_tointeger(L, -1));
+		lua_pop(L, 2);
+		if (!layout) {
+			lua_pop(L, 1);
+			throw std::string{ "<Script::Utils::PushCData> Unsupported cdata layout, LuaJIT has to be built with LJ_GC64 on 64 bit targets" };
+		}
+
+		lua_pushlightuserdata(L, const_cast< char* >(&CTypeKey));
+		new (lua_newuserdata(L, sizeof(CDataTypes))) CDataTypes{};
+		lua_createtable(L, 0, 1);
+		lua_pushcfunction(L, CollectCDataTypes);
+		lua_setfield(L, -2, "__gc");
+		lua_setmetatable(L, -2);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+
+		lua_newtable(L);
+		lua_insert(L, -2);
+		lua_rawseti(L, -2, 0);
+		lua_pushlightuserdata(L, const_cast< char* >(&CDataKey));
+		lua_pushvalue(L, -2);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+	}
+
+	lua_pushlightuserdata(L, const_cast< TypeInfo* >(type));
+	lua_rawget(L, -2);
+	if (!lua_isfunction(L, -1)) {
+		lua_pop(L, 1);
+
+		std::string ctype = "struct Script_" + metatable;
+		std::replace_if(ctype.begin() + 7, ctype.end(), [](const char character) {
+			return !std::isalnum(static_cast< unsigned char >(character)) && character != '_';
+		}, '_');
+		lua_rawgeti(L, -1, 0);
+		lua_pushlstring(L, ctype.data(), ctype.size());
+		lua_pushlstring(L, metatable.data(), metatable.size());
+		if (lua_pcall(L, 2, 2, 0)) {
+			throw std::string{ "<Script::Utils::PushCData> " } + lua_tostring(L, -1);
+		}
+
+		lua_pushlightuserdata(L, const_cast< char* >(&CTypeKey));
+		lua_rawget(L, LUA_REGISTRYINDEX);
+		CDataTypes* types = static_cast< CDataTypes* >(lua_touserdata(L, -1));
+		const size_t id = static_cast< size_t >(lua_tointeger(L, -2));
+		if (types->types.size() <= id) {
+			types->types.resize(id + 1, nullptr);
+			types->metatables.resize(id + 1);
+		}
+		types->types[ id ] = type;
+		types->metatables[ id ] = metatable;
+		lua_pop(L, 2);
+
+		lua_pushlightuserdata(L, const_cast< TypeInfo* >(type));
+		lua_pushvalue(L, -2);
+		lua_rawset(L, -4);
+	}
+
+	lua_remove(L, -2);
+	lua_pushlightuserdata(L, pointer);
+	lua_call(L, 1, 1);
+}
+
+auto Utils::ToCData(lua_State* L, const int32_t idx, TypeId& type) -> void*
+{
+	if (static_cast< VariableType >(lua_type(L, idx)) != VariableType::CData) {
+		return nullptr;
+	}
+	const void* payload = lua_topointer(L, idx);
+
+	lua_pushlightuserdata(L, const_cast< char* >(&CTypeKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	const CDataTypes* types = static_cast< const CDataTypes* >(lua_touserdata(L, -1));
+	lua_pop(L, 1);
+	if (!types) {
+		return nullptr;
+	}
+
+	const size_t id = GetCType(payload);
+	type = id < types->types.size() ? types->types[ id ] : nullptr;
+	if (!type) {
+		return nullptr;
+	}
+
+	// Pointer cdata payload is the pointer itself.
+	return const_cast< void* >(*static_cast< const void* const* >(payload));
+}
+
+void Utils::SetParentMetatable(lua_State* L, const int32_t metatableIdx, const int32_t parentIdx)
+{
+	const int32_t top = lua_gettop(L);
+	const int32_t metatable = metatableIdx < 0 ? top + metatableIdx + 1 : metatableIdx;
+	const int32_t parent = parentIdx < 0 ? top + parentIdx + 1 : parentIdx;
+
+	lua_pushlightuserdata(L, const_cast< char* >(&ParentKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+		lua_newtable(L);
+		lua_pushlightuserdata(L, const_cast< char* >(&ParentKey));
+		lua_pushvalue(L, -2);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+	}
+
+	lua_pushvalue(L, metatable);
+	lua_pushvalue(L, parent);
+	lua_rawset(L, -3);
+	lua_pop(L, 1);
+}
+
+auto Utils::InheritsMetatable(lua_State* L, const int32_t idx, const std::string& base) -> bool
+{
+	const int32_t top = lua_gettop(L);
+
+	if (static_cast< VariableType >(lua_type(L, idx)) == VariableType::CData) {
+		const size_t id = GetCType(lua_topointer(L, idx));
+		lua_pushlightuserdata(L, const_cast< char* >(&CTypeKey));
+		lua_rawget(L, LUA_REGISTRYINDEX);
+		const CDataTypes* types = static_cast< const CDataTypes* >(lua_touserdata(L, -1));
+		if (!types || id >= types->metatables.size() || types->metatables[ id ].empty()) {
+			lua_settop(L, top);
+			return false;
+		}
+		luaL_getmetatable(L, types->metatables[ id ].data());
+	} else if (!lua_getmetatable(L, idx)) {
+		return false;
+	}
+	const int32_t metatableIdx = lua_gettop(L);
+
+	luaL_getmetatable(L, base.data());
+	lua_pushlightuserdata(L, const_cast< char* >(&ParentKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+
+	bool inherits = false;
+	if (lua_istable(L, -1) && lua_istable(L, -2)) {
+		lua_pushvalue(L, metatableIdx);
+		while (lua_istable(L, -1) && !inherits) {
+			inherits = lua_rawequal(L, -1, -3);
+			lua_rawget(L, -2);
+		}
+	}
+
+	lua_settop(L, top);
+	return inherits;
+}
+
+void Utils::CountersCreate(lua_State* L, RuntimeCounters* counters)
+{
+	lua_pushlightuserdata(L, const_cast< char* >(&CountersKey));
+	lua_pushlightuserdata(L, counters);
+	lua_rawset(L, LUA_REGISTRYINDEX);
+
+	lua_newuserdata(L, 0);
+	lua_createtable(L, 0, 1);
+	lua_pushlightuserdata(L, counters);
+	lua_pushcclosure(L, CountCycle, 1);
+	lua_setfield(L, -2, "__gc");
+	lua_setmetatable(L, -2);
+	lua_pop(L, 1);
+}
+
+auto Utils::GetCounters(lua_State* L) -> RuntimeCounters*
+{
+	lua_pushlightuserdata(L, const_cast< char* >(&CountersKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	RuntimeCounters* counters = static_cast< RuntimeCounters* >(lua_touserdata(L, -1));
+	lua_pop(L, 1);
+	return counters;
+}
+
+void Utils::CountObject(lua_State* L, const int32_t idx, const int64_t delta)
+{
+	RuntimeCounters* counters = GetCounters(L);
+	if (!counters || !lua_getmetatable(L, idx)) {
+		return;
+	}
+
+	const void* metatable = lua_topointer(L, -1);
+	lua_pop(L, 1);
+
+	if (metatable != counters->lastMetatable) {
+		counters->lastMetatable = metatable;
+		counters->lastObjects = &counters->objects[ metatable ];
+	}
+	*counters->lastObjects += delta;
+}
+
+void Utils::CountFunction(lua_State* L, const int64_t delta)
+{
+	if (RuntimeCounters* counters = GetCounters(L)) {
+		counters->functions += delta;
+	}
+}
+
+auto Utils::ProtectedCall(lua_State* L, const int32_t nargs, const int32_t nresults, const int32_t errfunc) -> int32_t
+{
+	return ProtectedCall(L, GetCounters(L), nargs, nresults, errfunc);
+}
+
+auto Utils::ProtectedCall(lua_State* L, RuntimeCounters* counters, const int32_t nargs, const int32_t nresults, const int32_t errfunc) -> int32_t
+{
+	const int32_t status = lua_pcall(L, nargs, nresults, errfunc);
+	if (counters) {
+		counters->calls++;
+		counters->errors += status ? 1 : 0;
+	}
+	return status;
+}
+
 } // namespace Script
@@ -8,13 +8,32 @@ extern "C" {
 #include <cstdint>
 #include <string>
 #include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
+#include <Framework/Script/TypeRegistry.hpp>
+
 struct lua_State;
 
 namespace Script
 {
 
+// Counters of one engine, kept up to date by pushes, collectors and protected calls.
+struct RuntimeCounters
+{
+	// Live object userdata by metatable address.
+	std::unordered_map< const void*, int64_t > objects = {};
+	// Entry of the metatable counted last, objects are mostly pushed in runs of one class.
+	const void* lastMetatable = nullptr;
+	int64_t* lastObjects = nullptr;
+	int64_t functions = 0;
+	uint64_t calls = 0;
+	uint64_t errors = 0;
+	uint64_t gcCycles = 0;
+	// Set before the state closes, the cycle sentinel is not renewed from then on.
+	bool closing = false;
+};
+
 class Utils
 {
 public:
@@ -31,6 +50,32 @@ public:
 	[[nodiscard]] static auto WeakRefSet(lua_State*) -> int;
 	static void WeakUnref(lua_State*, const int referenceId);
 	static void WeakRefGet(lua_State*, const int referenceId);
+
+	static void IdentityCacheCreate(lua_State*, bool enabled);
+	[[nodiscard]] static auto IdentityCacheExists(lua_State*) -> bool;
+	[[nodiscard]] static auto IdentityCacheGet(lua_State*, const void* pointer) -> bool;
+	static void IdentityCacheSet(lua_State*, const void* pointer);
+
+	static void PushCData(lua_State*, void* pointer, const std::string& metatable, TypeId type);
+	// nullptr unless the value is a class pointer pushed by PushCData, type receives its class.
+	[[nodiscard]] static auto ToCData(lua_State*, const int32_t idx, TypeId& type) -> void*;
+
+	// Remembers the parent of a metatable created by Engine::GetMetatable(name, parent).
+	static void SetParentMetatable(lua_State*, const int32_t metatableIdx, const int32_t parentIdx);
+	// Whether the metatable of the object or class pointer at idx descends from base.
+	[[nodiscard]] static auto InheritsMetatable(lua_State*, const int32_t idx, const std::string& base) -> bool;
+
+	// The counters are owned by the caller and have to outlive the state.
+	static void CountersCreate(lua_State*, RuntimeCounters* counters);
+	// nullptr for states without counters.
+	[[nodiscard]] static auto GetCounters(lua_State*) -> RuntimeCounters*;
+	// Adds delta to the live objects of the metatable of the userdata at idx.
+	static void CountObject(lua_State*, const int32_t idx, const int64_t delta);
+	static void CountFunction(lua_State*, const int64_t delta);
+	// lua_pcall, counted with its errors.
+	[[nodiscard]] static auto ProtectedCall(lua_State*, const int32_t nargs, const int32_t nresults, const int32_t errfunc) -> int32_t;
+	// Same with counters resolved once by callers making calls in a loop, nullptr counts nothing.
+	[[nodiscard]] static auto ProtectedCall(lua_State*, RuntimeCounters* counters, const int32_t nargs, const int32_t nresults, const int32_t errfunc) -> int32_t;
 };
 
 template < class Class >
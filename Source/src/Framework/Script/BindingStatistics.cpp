@@ -0,0 +1,224 @@
+#include <Framework/Script/BindingStatistics.hpp>
+
+extern "C" {
+#include <lauxlib.h>
+}
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Script
+{
+
+namespace
+{
+
+constexpr uint32_t SubBucketBits = 2;
+constexpr uint32_t SubBuckets = 1 << SubBucketBits;
+constexpr uint32_t Octaves = 48;
+constexpr uint32_t Buckets = Octaves * SubBuckets;
+
+struct Entry
+{
+	std::string name = {};
+	std::atomic< uint64_t > calls = 0;
+	std::atomic< uint64_t > cycles = 0;
+	std::atomic< uint64_t > maxCycles = 0;
+	std::array< std::atomic< uint64_t >, Buckets > histogram = {};
+};
+
+std::mutex EntriesMutex = {};
+std::deque< Entry > Entries = {};
+std::unordered_map< std::string, Entry* > EntriesByName = {};
+
+inline auto ReadCycles() -> uint64_t
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return static_cast< uint64_t >(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+auto NanosecondsPerCycle() -> double
+{
+#if defined(__x86_64__) || defined(__i386__)
+	static const double ratio = [] {
+		const auto start = std::chrono::steady_clock::now();
+		const uint64_t startCycles = ReadCycles();
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+		const uint64_t cycles = ReadCycles() - startCycles;
+		const auto elapsed = std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now() - start);
+		return (cycles > 0) ? static_cast< double >(elapsed.count()) / static_cast< double >(cycles) : 1.0;
+	}();
+	return ratio;
+#else
+	return std::chrono::steady_clock::period::num * 1e9 / std::chrono::steady_clock::period::den;
+#endif
+}
+
+// Log-linear bucketing: every power of two is split into SubBuckets linear steps.
+inline auto BucketIndex(const uint64_t cycles) -> uint32_t
+{
+	if (cycles < SubBuckets) {
+		return static_cast< uint32_t >(cycles);
+	}
+
+	const uint32_t exponent = 63 - static_cast< uint32_t >(__builtin_clzll(cycles));
+	const uint32_t subBucket = static_cast< uint32_t >(cycles >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+	const uint32_t index = (exponent - SubBucketBits + 1) * SubBuckets + subBucket;
+	return std::min(index, Buckets - 1);
+}
+
+inline auto BucketUpperBound(const uint32_t index) -> uint64_t
+{
+	if (index < SubBuckets) {
+		return index + 1;
+	}
+
+	const uint32_t exponent = index / SubBuckets + SubBucketBits - 1;
+	const uint64_t subBucket = index % SubBuckets;
+	return (uint64_t{ 1 } << exponent) + ((subBucket + 1) << (exponent - SubBucketBits));
+}
+
+class Measurement final
+{
+public:
+	explicit Measurement(Entry* entry)
+		: mEntry(entry)
+		, mStart(ReadCycles())
+	{
+	}
+	Measurement(const Measurement&) = delete;
+	Measurement(Measurement&&) = delete;
+	Measurement& operator=(const Measurement&) = delete;
+	Measurement& operator=(Measurement&&) = delete;
+
+	~Measurement()
+	{
+		const uint64_t cycles = ReadCycles() - mStart;
+
+		mEntry->calls.fetch_add(1, std::memory_order_relaxed);
+		mEntry->cycles.fetch_add(cycles, std::memory_order_relaxed);
+		mEntry->histogram[ BucketIndex(cycles) ].fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t maxCycles = mEntry->maxCycles.load(std::memory_order_relaxed);
+		while (maxCycles < cycles && !mEntry->maxCycles.compare_exchange_weak(maxCycles, cycles, std::memory_order_relaxed)) { }
+	}
+
+private:
+	Entry* mEntry = {};
+	uint64_t mStart = 0;
+};
+
+auto Measure(lua_State* L) -> int
+{
+	const lua_CFunction call = lua_tocfunction(L, lua_upvalueindex(1));
+	const Measurement measurement{ static_cast< Entry* >(lua_touserdata(L, lua_upvalueindex(2))) };
+	return call(L);
+}
+
+auto FindEntry(const std::string& name) -> Entry*
+{
+	const std::lock_guard< std::mutex > lock{ EntriesMutex };
+
+	if (const auto it = EntriesByName.find(name); it != EntriesByName.end()) {
+		return it->second;
+	}
+
+	Entry& entry = Entries.emplace_back();
+	entry.name = name;
+	EntriesByName.emplace(name, &entry);
+	return &entry;
+}
+
+auto ToNanoseconds(const uint64_t cycles) -> std::chrono::nanoseconds
+{
+	return std::chrono::nanoseconds{ static_cast< int64_t >(static_cast< double >(cycles) * NanosecondsPerCycle()) };
+}
+
+} // namespace
+
+auto BindingStatistics::Snapshot() -> std::vector< Record >
+{
+	const std::lock_guard< std::mutex > lock{ EntriesMutex };
+
+	std::vector< Record > records = {};
+	records.reserve(Entries.size());
+
+	for (const Entry& entry : Entries) {
+		Record& record = records.emplace_back();
+		record.name = entry.name;
+		record.calls = entry.calls.load(std::memory_order_relaxed);
+		record.total = ToNanoseconds(entry.cycles.load(std::memory_order_relaxed));
+		record.max = ToNanoseconds(entry.maxCycles.load(std::memory_order_relaxed));
+
+		for (uint32_t index = 0; index < Buckets; ++index) {
+			if (const uint64_t count = entry.histogram[ index ].load(std::memory_order_relaxed)) {
+				record.histogram.emplace_back(ToNanoseconds(BucketUpperBound(index)), count);
+			}
+		}
+	}
+
+	return records;
+}
+
+void BindingStatistics::Reset()
+{
+	const std::lock_guard< std::mutex > lock{ EntriesMutex };
+
+	for (Entry& entry : Entries) {
+		entry.calls = 0;
+		entry.cycles = 0;
+		entry.maxCycles = 0;
+		for (std::atomic< uint64_t >& bucket : entry.histogram) {
+			bucket = 0;
+		}
+	}
+}
+
+void BindingStatistics::Instrument(lua_State* L, const int32_t tableIdx, const std::string_view field)
+{
+	const int32_t table = (tableIdx < 0) ? lua_gettop(L) + tableIdx + 1 : tableIdx;
+
+	if (!lua_isuserdata(L, -1) || !lua_getmetatable(L, -1)) {
+		return;
+	}
+
+	lua_getfield(L, -1, "__call");
+	if (!lua_iscfunction(L, -1)) {
+		lua_pop(L, 2);
+		return;
+	}
+
+	lua_pushstring(L, "__name");
+	lua_rawget(L, table);
+	if (lua_isnil(L, -1) && lua_getmetatable(L, table)) {
+		lua_pushstring(L, "__name");
+		lua_rawget(L, -2);
+		lua_remove(L, -2);
+		lua_remove(L, -2);
+	}
+
+	std::string name = {};
+	if (lua_type(L, -1) == LUA_TSTRING) {
+		name.append(lua_tostring(L, -1)).push_back('.');
+	}
+	name.append(field);
+	lua_pop(L, 1);
+
+	lua_pushlightuserdata(L, FindEntry(name));
+	lua_pushcclosure(L, Measure, 2);
+	lua_setfield(L, -2, "__call");
+	lua_pop(L, 1);
+}
+
+} // namespace Script
@@ -0,0 +1,50 @@
+#ifndef FRAMEWORK_SCRIPT_BINDINGSTATISTICS_HPP
+#define FRAMEWORK_SCRIPT_BINDINGSTATISTICS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct lua_State;
+
+namespace Script
+{
+
+// Per-binding call counters and latency histograms. Bindings are only
+// instrumented when the library is built with SCRIPT_BINDING_STATISTICS,
+// otherwise Instrument() is never referenced and snapshots stay empty.
+class BindingStatistics final
+{
+public:
+	struct Record
+	{
+		std::string name = {};
+		uint64_t calls = 0;
+		std::chrono::nanoseconds total = {};
+		std::chrono::nanoseconds max = {};
+		std::vector< std::pair< std::chrono::nanoseconds, uint64_t > > histogram = {};
+	};
+
+	[[nodiscard]] static constexpr auto IsEnabled() -> bool;
+
+	[[nodiscard]] static auto Snapshot() -> std::vector< Record >;
+	static void Reset();
+
+	static void Instrument(lua_State*, int32_t tableIdx, std::string_view field);
+};
+
+constexpr auto BindingStatistics::IsEnabled() -> bool
+{
+#ifdef SCRIPT_BINDING_STATISTICS
+	return true;
+#else
+	return false;
+#endif
+}
+
+} // namespace Script
+
+#endif
@@ -0,0 +1,346 @@
+#include <Framework/Script/Bundle.hpp>
+
+extern "C" {
+#include <lauxlib.h>
+}
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <tuple>
+#include <vector>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Script
+{
+
+namespace
+{
+
+constexpr char Magic[ 4 ] = { 'S', 'C', 'R', 'B' };
+constexpr uint32_t Version = 1;
+constexpr size_t HeaderSize = 16;
+constexpr size_t EntrySize = 24;
+
+constexpr const char* BundleMetatable = "ScriptBundle";
+
+auto Hash(const std::string_view name) -> uint64_t
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (const char character : name) {
+		hash ^= static_cast< uint8_t >(character);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+template < typename Type >
+auto Read(const char* data) -> Type
+{
+	Type value = {};
+	std::memcpy(&value, data, sizeof(Type));
+	return value;
+}
+
+template < typename Type >
+void Append(std::string& data, const Type value)
+{
+	char bytes[ sizeof(Type) ] = {};
+	std::memcpy(bytes, &value, sizeof(Type));
+	data.append(bytes, sizeof(Type));
+}
+
+auto DumpWriter(lua_State*, const void* data, const size_t size, void* output) -> int32_t
+{
+	static_cast< std::string* >(output)->append(static_cast< const char* >(data), size);
+	return 0;
+}
+
+} // namespace
+
+////////////////      Bundle     ////////////////
+
+auto Bundle::Open(const std::string& filename) -> BundlePtr
+{
+	BundlePtr bundle{ new Bundle{} };
+
+#ifdef __unix__
+	const int32_t descriptor = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (descriptor < 0) {
+		throw std::string{ "<Script::Bundle::Open> Can't open '" } + filename + "'";
+	}
+
+	struct stat status = {};
+	const bool valid = fstat(descriptor, &status) == 0 && static_cast< size_t >(status.st_size) >= HeaderSize;
+	void* mapping = valid ? mmap(nullptr, static_cast< size_t >(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0) : MAP_FAILED;
+	close(descriptor);
+
+	if (mapping == MAP_FAILED) {
+		throw std::string{ "<Script::Bundle::Open> Can't map '" } + filename + "'";
+	}
+	bundle->mMapping = mapping;
+	bundle->mData = static_cast< const char* >(mapping);
+	bundle->mSize = static_cast< size_t >(status.st_size);
+#else
+	std::ifstream file{ filename, std::ios::binary };
+	if (!file) {
+		throw std::string{ "<Script::Bundle::Open> Can't open '" } + filename + "'";
+	}
+	bundle->mStorage.assign(std::istreambuf_iterator< char >{ file }, std::istreambuf_iterator< char >{});
+	bundle->mData = bundle->mStorage.data();
+	bundle->mSize = bundle->mStorage.size();
+#endif
+
+	bundle->Validate("<Script::Bundle::Open>");
+	return bundle;
+}
+
+auto Bundle::FromMemory(std::string data) -> BundlePtr
+{
+	BundlePtr bundle{ new Bundle{} };
+	bundle->mStorage = std::move(data);
+	bundle->mData = bundle->mStorage.data();
+	bundle->mSize = bundle->mStorage.size();
+
+	bundle->Validate("<Script::Bundle::FromMemory>");
+	return bundle;
+}
+
+Bundle::~Bundle()
+{
+#ifdef __unix__
+	if (mMapping) {
+		munmap(mMapping, mSize);
+	}
+#endif
+}
+
+void Bundle::Validate(const std::string& context)
+{
+	if (mSize < HeaderSize || std::memcmp(mData, Magic, sizeof(Magic)) != 0 || Read< uint32_t >(mData + 4) != Version) {
+		throw context + " Invalid bundle header";
+	}
+
+	mCount = Read< uint32_t >(mData + 8);
+	if (mSize < HeaderSize + static_cast< size_t >(mCount) * EntrySize) {
+		throw context + " Truncated bundle index";
+	}
+
+	for (uint32_t i = 0; i < mCount; ++i) {
+		const Entry entry = GetEntry(i);
+		if (static_cast< size_t >(entry.nameOffset) + entry.nameLength > mSize ||
+			static_cast< size_t >(entry.dataOffset) + entry.dataLength > mSize) {
+			throw context + " Bundle entry out of bounds";
+		}
+	}
+}
+
+auto Bundle::GetEntry(const uint32_t index) const -> Entry
+{
+	const char* data = mData + HeaderSize + static_cast< size_t >(index) * EntrySize;
+	return Entry{
+		.hash = Read< uint64_t >(data),
+		.nameOffset = Read< uint32_t >(data + 8),
+		.nameLength = Read< uint32_t >(data + 12),
+		.dataOffset = Read< uint32_t >(data + 16),
+		.dataLength = Read< uint32_t >(data + 20),
+	};
+}
+
+auto Bundle::Find(const std::string_view name) const -> std::optional< std::string_view >
+{
+	const uint64_t hash = Hash(name);
+
+	uint32_t low = 0;
+	uint32_t high = mCount;
+	while (low < high) {
+		const uint32_t middle = low + (high - low) / 2;
+		if (GetEntry(middle).hash < hash) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	for (; low < mCount; ++low) {
+		const Entry entry = GetEntry(low);
+		if (entry.hash != hash) {
+			break;
+		}
+		if (std::string_view{ mData + entry.nameOffset, entry.nameLength } == name) {
+			return std::string_view{ mData + entry.dataOffset, entry.dataLength };
+		}
+	}
+	return {};
+}
+
+void Bundle::Install(lua_State* L, const BundlePtr& bundle)
+{
+	lua_getglobal(L, "package");
+	lua_getfield(L, -1, "loaders");
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 2);
+		return;
+	}
+	const int32_t loaders = lua_gettop(L);
+
+	new (lua_newuserdata(L, sizeof(BundlePtr))) BundlePtr{ bundle };
+	if (luaL_newmetatable(L, BundleMetatable)) {
+		lua_pushcfunction(L, Collect);
+		lua_setfield(L, -2, "__gc");
+	}
+	lua_setmetatable(L, -2);
+	lua_pushcclosure(L, Search, 1);
+
+	for (int32_t i = static_cast< int32_t >(lua_objlen(L, loaders)); i >= 2; --i) {
+		lua_rawgeti(L, loaders, i);
+		lua_rawseti(L, loaders, i + 1);
+	}
+	lua_rawseti(L, loaders, 2);
+	lua_pop(L, 2);
+}
+
+auto Bundle::Search(lua_State* L) -> int32_t
+{
+	size_t length = 0;
+	const char* name = luaL_checklstring(L, 1, &length);
+	const Bundle& bundle = **static_cast< BundlePtr* >(lua_touserdata(L, lua_upvalueindex(1)));
+
+	const std::optional< std::string_view > data = bundle.Find(std::string_view{ name, length });
+	if (!data) {
+		lua_pushfstring(L, "\n\tno module '%s' in bundle", name);
+		return 1;
+	}
+
+	const std::string chunkname = "@" + std::string{ name, length };
+	if (luaL_loadbuffer(L, data->data(), data->size(), chunkname.c_str())) {
+		return luaL_error(L, "error loading module '%s' from bundle:\n\t%s", name, lua_tostring(L, -1));
+	}
+	return 1;
+}
+
+auto Bundle::Collect(lua_State* L) -> int32_t
+{
+	static_cast< BundlePtr* >(lua_touserdata(L, 1))->~BundlePtr();
+	return 0;
+}
+
+////////////////      BundleBuilder     ////////////////
+
+void BundleBuilder::Add(const std::string& name, std::string data)
+{
+	mModules.insert_or_assign(name, std::move(data));
+}
+
+void BundleBuilder::AddDirectory(const std::filesystem::path& directory)
+{
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator{ directory }) {
+		if (!entry.is_regular_file() || entry.path().extension() != ".lua") {
+			continue;
+		}
+
+		std::filesystem::path relative = entry.path().lexically_relative(directory).replace_extension();
+		if (relative.filename() == "init") {
+			relative = relative.parent_path();
+		}
+
+		std::string name = {};
+		for (const std::filesystem::path& part : relative) {
+			name += (name.empty() ? "" : ".") + part.string();
+		}
+		if (name.empty()) {
+			continue;
+		}
+
+		std::ifstream file{ entry.path(), std::ios::binary };
+		Add(name, std::string{ std::istreambuf_iterator< char >{ file }, std::istreambuf_iterator< char >{} });
+	}
+}
+
+void BundleBuilder::Compile()
+{
+	lua_State* L = luaL_newstate();
+
+	for (auto& [ name, data ] : mModules) {
+		const std::string chunkname = "@" + name;
+		if (luaL_loadbuffer(L, data.data(), data.size(), chunkname.c_str())) {
+			std::string error = lua_tostring(L, -1);
+			lua_close(L);
+			throw "<Script::BundleBuilder::Compile> " + error;
+		}
+
+		std::string bytecode = {};
+		lua_dump(L, DumpWriter, &bytecode);
+		lua_pop(L, 1);
+		data = std::move(bytecode);
+	}
+
+	lua_close(L);
+}
+
+auto BundleBuilder::Build() const -> std::string
+{
+	std::vector< std::tuple< uint64_t, const std::string*, const std::string* > > entries = {};
+	entries.reserve(mModules.size());
+	for (const auto& [ name, data ] : mModules) {
+		entries.emplace_back(Hash(name), &name, &data);
+	}
+	std::sort(entries.begin(), entries.end(), [](const auto& left, const auto& right) {
+		return std::tie(std::get< 0 >(left), *std::get< 1 >(left)) < std::tie(std::get< 0 >(right), *std::get< 1 >(right));
+	});
+
+	size_t names = HeaderSize + entries.size() * EntrySize;
+	size_t datas = names;
+	for (const auto& [ hash, name, data ] : entries) {
+		datas += name->size();
+	}
+
+	std::string output = {};
+	output.append(Magic, sizeof(Magic));
+	Append(output, Version);
+	Append(output, static_cast< uint32_t >(entries.size()));
+	Append(output, uint32_t{ 0 });
+
+	for (const auto& [ hash, name, data ] : entries) {
+		if (datas + data->size() > std::numeric_limits< uint32_t >::max()) {
+			throw std::string{ "<Script::BundleBuilder::Build> Bundle is too large" };
+		}
+
+		Append(output, hash);
+		Append(output, static_cast< uint32_t >(names));
+		Append(output, static_cast< uint32_t >(name->size()));
+		Append(output, static_cast< uint32_t >(datas));
+		Append(output, static_cast< uint32_t >(data->size()));
+		names += name->size();
+		datas += data->size();
+	}
+
+	for (const auto& [ hash, name, data ] : entries) {
+		output.append(*name);
+	}
+	for (const auto& [ hash, name, data ] : entries) {
+		output.append(*data);
+	}
+	return output;
+}
+
+void BundleBuilder::Write(const std::string& filename) const
+{
+	const std::string data = Build();
+
+	std::ofstream file{ filename, std::ios::binary | std::ios::trunc };
+	if (!file.write(data.data(), static_cast< std::streamsize >(data.size()))) {
+		throw std::string{ "<Script::BundleBuilder::Write> Can't write '" } + filename + "'";
+	}
+}
+
+} // namespace Script
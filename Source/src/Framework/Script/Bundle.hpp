@@ -0,0 +1,100 @@
+#ifndef FRAMEWORK_SCRIPT_BUNDLE_HPP
+#define FRAMEWORK_SCRIPT_BUNDLE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+struct lua_State;
+
+namespace Script
+{
+
+// Read-only set of modules packed into one file or memory block:
+//   header { "SCRB", version, count, 0 }
+//   index  { fnv1a(name), name offset, name length, data offset, data length }[ count ], sorted by hash
+//   names and module data (source or bytecode)
+// A file is memory-mapped once and can be installed into any number of engines, require()
+// then resolves bundled modules with a hash lookup instead of probing package.path.
+class Bundle final
+{
+public:
+	[[nodiscard]] static auto Open(const std::string& filename) -> std::shared_ptr< Bundle >;
+	[[nodiscard]] static auto FromMemory(std::string data) -> std::shared_ptr< Bundle >;
+
+	Bundle(const Bundle&) = delete;
+	Bundle(Bundle&&) = delete;
+	Bundle& operator=(const Bundle&) = delete;
+	Bundle& operator=(Bundle&&) = delete;
+	~Bundle();
+
+	[[nodiscard]] auto Find(std::string_view name) const -> std::optional< std::string_view >;
+	[[nodiscard]] inline auto GetCount() const -> uint32_t;
+
+	// Adds a searcher to package.loaders right after the preload one.
+	static void Install(lua_State*, const std::shared_ptr< Bundle >&);
+
+private:
+	struct Entry
+	{
+		uint64_t hash = 0;
+		uint32_t nameOffset = 0;
+		uint32_t nameLength = 0;
+		uint32_t dataOffset = 0;
+		uint32_t dataLength = 0;
+	};
+
+	explicit Bundle() = default;
+
+	void Validate(const std::string& context);
+	[[nodiscard]] auto GetEntry(uint32_t index) const -> Entry;
+
+	static auto Search(lua_State*) -> int32_t;
+	static auto Collect(lua_State*) -> int32_t;
+
+private:
+	const char* mData = nullptr;
+	size_t mSize = 0;
+	uint32_t mCount = 0;
+
+	std::string mStorage = {};
+	void* mMapping = nullptr;
+};
+
+using BundlePtr = std::shared_ptr< Bundle >;
+
+class BundleBuilder final
+{
+public:
+	void Add(const std::string& name, std::string data);
+	// Adds every *.lua file below directory, a/b.lua becomes module a.b and a/init.lua module a.
+	void AddDirectory(const std::filesystem::path& directory);
+	// Replaces sources with bytecode, throws on syntax errors.
+	void Compile();
+
+	[[nodiscard]] auto Build() const -> std::string;
+	void Write(const std::string& filename) const;
+
+	[[nodiscard]] inline auto GetModules() const -> const std::map< std::string, std::string >&;
+
+private:
+	std::map< std::string, std::string > mModules = {};
+};
+
+auto Bundle::GetCount() const -> uint32_t
+{
+	return mCount;
+}
+
+auto BundleBuilder::GetModules() const -> const std::map< std::string, std::string >&
+{
+	return mModules;
+}
+
+} // namespace Script
+
+#endif
@@ -0,0 +1,625 @@
+#include <Framework/Script/Channel.hpp>
+
+#include <Framework/Script/ObjectOwnership.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+namespace Script
+{
+
+namespace
+{
+
+enum class Tag : uint8_t {
+	Nil = 0,
+	False = 1,
+	True = 2,
+	Integer = 3,
+	Number = 4,
+	String = 5,
+	Table = 6,
+	Object = 7,
+};
+
+// Deep enough for any sane payload, shallow enough to reject cyclic tables.
+constexpr uint32_t MaxDepth = 32;
+constexpr double MaxInteger = 9007199254740992.0;
+
+constexpr const char* ChannelMetatable = "ScriptChannel";
+constexpr const char* OrphanMetatable = "ScriptChannelObject";
+
+void WriteTag(std::string& data, const Tag tag)
+{
+	data.push_back(static_cast< char >(tag));
+}
+
+void WriteVarint(std::string& data, uint64_t value)
+{
+	while (value >= 0x80) {
+		data.push_back(static_cast< char >((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	data.push_back(static_cast< char >(value));
+}
+
+auto ReadVarint(const std::string& data, size_t& offset) -> uint64_t
+{
+	uint64_t value = 0;
+	for (uint32_t shift = 0;; shift += 7) {
+		const uint8_t byte = static_cast< uint8_t >(data[ offset++ ]);
+		value |= static_cast< uint64_t >(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			return value;
+		}
+	}
+}
+
+auto IsArrayKey(lua_State* L, const int32_t idx, const size_t length) -> bool
+{
+	if (lua_type(L, idx) != LUA_TNUMBER) {
+		return false;
+	}
+
+	const lua_Number key = lua_tonumber(L, idx);
+	return key >= 1 && key <= static_cast< lua_Number >(length) && std::floor(key) == key;
+}
+
+auto EncodeOrRaise(lua_State* L, const int32_t idx) -> Message
+{
+	Message message = {};
+	if (const char* error = message.Encode(L, idx)) {
+		luaL_error(L, "%s", error);
+	}
+	return message;
+}
+
+auto GetChannel(lua_State* L) -> Channel&
+{
+	const ChannelPtr& channel = *static_cast< ChannelPtr* >(luaL_checkudata(L, 1, ChannelMetatable));
+	if (!channel) {
+		luaL_error(L, "<Script::Channel> Channel was collected");
+	}
+	return *channel;
+}
+
+// Scripts may call __gc themselves, an empty pointer owns nothing and needs no destructor.
+auto ChannelCollect(lua_State* L) -> int32_t
+{
+	static_cast< ChannelPtr* >(luaL_checkudata(L, 1, ChannelMetatable))->reset();
+	return 0;
+}
+
+auto ChannelLength(lua_State* L) -> int32_t
+{
+	lua_pushinteger(L, static_cast< lua_Integer >(GetChannel(L).GetSize()));
+	return 1;
+}
+
+auto ChannelSend(lua_State* L) -> int32_t
+{
+	Channel& channel = GetChannel(L);
+	lua_pushboolean(L, channel.Send(EncodeOrRaise(L, 2)));
+	return 1;
+}
+
+auto ChannelSendBatch(lua_State* L) -> int32_t
+{
+	Channel& channel = GetChannel(L);
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	const size_t length = lua_objlen(L, 2);
+	std::vector< Message > messages = {};
+	messages.reserve(length);
+	for (size_t i = 1; i <= length; ++i) {
+		lua_rawgeti(L, 2, static_cast< int32_t >(i));
+		messages.push_back(EncodeOrRaise(L, -1));
+		lua_pop(L, 1);
+	}
+
+	lua_pushinteger(L, static_cast< lua_Integer >(channel.SendBatch(messages)));
+	return 1;
+}
+
+auto ChannelReceive(lua_State* L) -> int32_t
+{
+	const std::optional< Message > message = GetChannel(L).Receive();
+	if (!message) {
+		lua_pushboolean(L, false);
+		return 1;
+	}
+
+	lua_pushboolean(L, true);
+	message->Decode(L);
+	return 2;
+}
+
+auto ChannelReceiveBatch(lua_State* L) -> int32_t
+{
+	Channel& channel = GetChannel(L);
+	const size_t max = static_cast< size_t >(luaL_optinteger(L, 2, static_cast< lua_Integer >(channel.GetCapacity())));
+
+	std::vector< Message > messages = {};
+	const size_t count = channel.ReceiveBatch(messages, max);
+
+	lua_createtable(L, static_cast< int32_t >(count), 0);
+	for (size_t i = 0; i < count; ++i) {
+		messages[ i ].Decode(L);
+		lua_rawseti(L, -2, static_cast< int32_t >(i + 1));
+	}
+	lua_pushinteger(L, static_cast< lua_Integer >(count));
+	return 2;
+}
+
+auto ChannelStatisticsTable(lua_State* L) -> int32_t
+{
+	const ChannelStatistics statistics = GetChannel(L).GetStatistics();
+
+	lua_createtable(L, 0, 4);
+	lua_pushnumber(L, static_cast< lua_Number >(statistics.sent));
+	lua_setfield(L, -2, "sent");
+	lua_pushnumber(L, static_cast< lua_Number >(statistics.received));
+	lua_setfield(L, -2, "received");
+	lua_pushnumber(L, static_cast< lua_Number >(statistics.rejected));
+	lua_setfield(L, -2, "rejected");
+	lua_pushnumber(L, static_cast< lua_Number >(statistics.bytes));
+	lua_setfield(L, -2, "bytes");
+	return 1;
+}
+
+void PushChannelMetatable(lua_State* L)
+{
+	if (!luaL_newmetatable(L, ChannelMetatable)) {
+		return;
+	}
+
+	constexpr luaL_Reg Methods[] = {
+		{ "Send", ChannelSend },
+		{ "SendBatch", ChannelSendBatch },
+		{ "Receive", ChannelReceive },
+		{ "ReceiveBatch", ChannelReceiveBatch },
+		{ "Statistics", ChannelStatisticsTable },
+		{ nullptr, nullptr },
+	};
+	lua_newtable(L);
+	luaL_register(L, nullptr, Methods);
+	lua_setfield(L, -2, "__index");
+
+	lua_pushcfunction(L, ChannelCollect);
+	lua_setfield(L, -2, "__gc");
+	lua_pushcfunction(L, ChannelLength);
+	lua_setfield(L, -2, "__len");
+	lua_pushstring(L, ChannelMetatable);
+	lua_setfield(L, -2, "__name");
+}
+
+auto OrphanCollect(lua_State* L) -> int32_t
+{
+	if (ObjectHeader* header = ObjectHeader::Get(L, 1)) {
+		Utils::CountObject(L, 1, -1);
+		delete header->ownership;
+		header->ownership = nullptr;
+	}
+	return 0;
+}
+
+// Objects whose class isn't registered in the receiving engine still have to release their ownership.
+void PushOrphanMetatable(lua_State* L)
+{
+	if (!luaL_newmetatable(L, OrphanMetatable)) {
+		return;
+	}
+
+	lua_pushcfunction(L, OrphanCollect);
+	lua_setfield(L, -2, "__gc");
+	lua_pushstring(L, OrphanMetatable);
+	lua_setfield(L, -2, "__name");
+}
+
+} // namespace
+
+////////////////      Message     ////////////////
+
+auto Message::Encode(lua_State* L, const int32_t idx) -> const char*
+{
+	mData.clear();
+	mObjects.clear();
+
+	const int32_t absoluteIdx = (idx < 0 && idx > LUA_REGISTRYINDEX) ? lua_gettop(L) + idx + 1 : idx;
+	return EncodeValue(L, absoluteIdx, 0);
+}
+
+auto Message::EncodeValue(lua_State* L, const int32_t idx, const uint32_t depth) -> const char*
+{
+	switch (lua_type(L, idx)) {
+		case LUA_TNIL:
+			WriteTag(mData, Tag::Nil);
+			return nullptr;
+
+		case LUA_TBOOLEAN:
+			WriteTag(mData, lua_toboolean(L, idx) ? Tag::True : Tag::False);
+			return nullptr;
+
+		case LUA_TNUMBER: {
+			const lua_Number number = lua_tonumber(L, idx);
+			if (number >= -MaxInteger && number <= MaxInteger && std::floor(number) == number && !std::signbit(number)) {
+				WriteTag(mData, Tag::Integer);
+				WriteVarint(mData, static_cast< uint64_t >(number) << 1);
+			} else if (number >= -MaxInteger && number < 0 && std::floor(number) == number) {
+				WriteTag(mData, Tag::Integer);
+				WriteVarint(mData, (static_cast< uint64_t >(-number) << 1) - 1);
+			} else {
+				char bytes[ sizeof(lua_Number) ] = {};
+				std::memcpy(bytes, &number, sizeof(number));
+				WriteTag(mData, Tag::Number);
+				mData.append(bytes, sizeof(bytes));
+			}
+			return nullptr;
+		}
+
+		case LUA_TSTRING: {
+			size_t length = 0;
+			const char* value = lua_tolstring(L, idx, &length);
+			WriteTag(mData, Tag::String);
+			WriteVarint(mData, length);
+			mData.append(value, length);
+			return nullptr;
+		}
+
+		case LUA_TTABLE: {
+			if (depth >= MaxDepth) {
+				return "table nesting is too deep or cyclic";
+			}
+			if (!lua_checkstack(L, 3)) {
+				return "stack overflow";
+			}
+
+			const size_t length = lua_objlen(L, idx);
+			uint64_t pairs = 0;
+			lua_pushnil(L);
+			while (lua_next(L, idx)) {
+				pairs += IsArrayKey(L, -2, length) ? 0 : 1;
+				lua_pop(L, 1);
+			}
+
+			WriteTag(mData, Tag::Table);
+			WriteVarint(mData, length);
+			WriteVarint(mData, pairs);
+
+			for (size_t i = 1; i <= length; ++i) {
+				lua_rawgeti(L, idx, static_cast< int32_t >(i));
+				const char* error = EncodeValue(L, lua_gettop(L), depth + 1);
+				lua_pop(L, 1);
+				if (error) {
+					return error;
+				}
+			}
+
+			lua_pushnil(L);
+			while (lua_next(L, idx)) {
+				if (!IsArrayKey(L, -2, length)) {
+					const int32_t top = lua_gettop(L);
+					const char* error = EncodeValue(L, top - 1, depth + 1);
+					if (!error) {
+						error = EncodeValue(L, top, depth + 1);
+					}
+					if (error) {
+						lua_pop(L, 2);
+						return error;
+					}
+				}
+				lua_pop(L, 1);
+			}
+			return nullptr;
+		}
+
+		case LUA_TUSERDATA: {
+			const ObjectHeader* header = ObjectHeader::Get(L, idx);
+			if (!header) {
+				return "only registered objects can be sent";
+			}
+
+			Object object = {
+				.ownership = header->ownership->Get(),
+				.type = header->type,
+				.pointer = header->pointer,
+			};
+			if (lua_getmetatable(L, idx)) {
+				lua_getfield(L, -1, "__name");
+				if (const char* name = lua_tostring(L, -1)) {
+					object.metatable = name;
+				}
+				lua_pop(L, 2);
+			}
+
+			WriteTag(mData, Tag::Object);
+			WriteVarint(mData, mObjects.size());
+			mObjects.push_back(std::move(object));
+			return nullptr;
+		}
+
+		default:
+			return "value type can't be sent";
+	}
+}
+
+void Message::Decode(lua_State* L) const
+{
+	if (mData.empty()) {
+		lua_pushnil(L);
+		return;
+	}
+
+	size_t offset = 0;
+	DecodeValue(L, offset);
+}
+
+void Message::DecodeValue(lua_State* L, size_t& offset) const
+{
+	const Tag tag = static_cast< Tag >(mData[ offset++ ]);
+
+	switch (tag) {
+		case Tag::Nil:
+			lua_pushnil(L);
+			return;
+
+		case Tag::False:
+		case Tag::True:
+			lua_pushboolean(L, tag == Tag::True);
+			return;
+
+		case Tag::Integer: {
+			const uint64_t value = ReadVarint(mData, offset);
+			// Encoded non-negative values are even, negative ones odd.
+			if (value & 1) {
+				lua_pushnumber(L, -static_cast< lua_Number >((value + 1) >> 1));
+			} else {
+				lua_pushnumber(L, static_cast< lua_Number >(value >> 1));
+			}
+			return;
+		}
+
+		case Tag::Number: {
+			lua_Number number = 0;
+			std::memcpy(&number, mData.data() + offset, sizeof(number));
+			offset += sizeof(number);
+			lua_pushnumber(L, number);
+			return;
+		}
+
+		case Tag::String: {
+			const size_t length = static_cast< size_t >(ReadVarint(mData, offset));
+			lua_pushlstring(L, mData.data() + offset, length);
+			offset += length;
+			return;
+		}
+
+		case Tag::Table: {
+			const size_t length = static_cast< size_t >(ReadVarint(mData, offset));
+			const size_t pairs = static_cast< size_t >(ReadVarint(mData, offset));
+
+			luaL_checkstack(L, 3, "<Script::Message::Decode> stack overflow");
+			lua_createtable(L, static_cast< int32_t >(length), static_cast< int32_t >(pairs));
+			for (size_t i = 1; i <= length; ++i) {
+				DecodeValue(L, offset);
+				lua_rawseti(L, -2, static_cast< int32_t >(i));
+			}
+			for (size_t i = 0; i < pairs; ++i) {
+				DecodeValue(L, offset);
+				DecodeValue(L, offset);
+				lua_rawset(L, -3);
+			}
+			return;
+		}
+
+		case Tag::Object: {
+			const Object& object = mObjects[ static_cast< size_t >(ReadVarint(mData, offset)) ];
+
+			if (Utils::IdentityCacheGet(L, object.pointer)) {
+				const ObjectHeader* header = ObjectHeader::Get(L, -1);
+				if (header && header->type == object.type) {
+					return;
+				}
+				lua_pop(L, 1);
+			}
+
+			ObjectHeader* header = static_cast< ObjectHeader* >(lua_newuserdata(L, sizeof(ObjectHeader)));
+			*header = ObjectHeader{
+				.ownership = new ObjectOwnership{ object.ownership },
+				.type = object.type,
+				.pointer = object.pointer,
+			};
+			luaL_getmetatable(L, object.metatable.c_str());
+			if (lua_isnil(L, -1)) {
+				lua_pop(L, 1);
+				PushOrphanMetatable(L);
+			}
+			lua_setmetatable(L, -2);
+
+			Utils::CountObject(L, -1, 1);
+			Utils::IdentityCacheSet(L, object.pointer);
+			return;
+		}
+	}
+
+	lua_pushnil(L);
+}
+
+////////////////      Channel     ////////////////
+
+Channel::Channel(const size_t capacity)
+	: mMask(std::bit_ceil(std::max(capacity, size_t{ 1 })) - 1)
+	, mCells(new Cell[ mMask + 1 ])
+{
+	for (size_t i = 0; i <= mMask; ++i) {
+		mCells[ i ].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+auto Channel::Claim(const size_t count, size_t& position) -> size_t
+{
+	position = mHead.load(std::memory_order_relaxed);
+
+	for (;;) {
+		const size_t sequence = mCells[ position & mMask ].sequence.load(std::memory_order_acquire);
+		const intptr_t difference = static_cast< intptr_t >(sequence) - static_cast< intptr_t >(position);
+
+		if (difference < 0) {
+			return 0;
+		}
+		if (difference > 0) {
+			position = mHead.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		// The consumer frees slots in order, so the free run starting at position is contiguous.
+		size_t claimed = 1;
+		while (claimed < count && claimed <= mMask &&
+			mCells[ (position + claimed) & mMask ].sequence.load(std::memory_order_acquire) == position + claimed) {
+			++claimed;
+		}
+
+		if (mHead.compare_exchange_weak(position, position + claimed, std::memory_order_relaxed)) {
+			return claimed;
+		}
+	}
+}
+
+void Channel::Publish(const size_t position, Message&& message)
+{
+	Cell& cell = mCells[ position & mMask ];
+	cell.message = std::move(message);
+	cell.sequence.store(position + 1, std::memory_order_release);
+}
+
+auto Channel::Send(Message message) -> bool
+{
+	size_t position = 0;
+	if (!Claim(1, position)) {
+		mRejected.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	const size_t bytes = message.GetSize();
+	Publish(position, std::move(message));
+
+	mSent.fetch_add(1, std::memory_order_relaxed);
+	mBytes.fetch_add(bytes, std::memory_order_relaxed);
+	return true;
+}
+
+auto Channel::SendBatch(std::vector< Message >& messages) -> size_t
+{
+	if (messages.empty()) {
+		return 0;
+	}
+
+	size_t position = 0;
+	const size_t claimed = Claim(messages.size(), position);
+
+	size_t bytes = 0;
+	for (size_t i = 0; i < claimed; ++i) {
+		bytes += messages[ i ].GetSize();
+		Publish(position + i, std::move(messages[ i ]));
+	}
+	messages.erase(messages.begin(), messages.begin() + static_cast< std::ptrdiff_t >(claimed));
+
+	mSent.fetch_add(claimed, std::memory_order_relaxed);
+	mBytes.fetch_add(bytes, std::memory_order_relaxed);
+	mRejected.fetch_add(messages.size(), std::memory_order_relaxed);
+	return claimed;
+}
+
+auto Channel::Receive() -> std::optional< Message >
+{
+	const size_t tail = mTail.load(std::memory_order_relaxed);
+	Cell& cell = mCells[ tail & mMask ];
+	if (cell.sequence.load(std::memory_order_acquire) != tail + 1) {
+		return {};
+	}
+
+	std::optional< Message > message{ std::move(cell.message) };
+	cell.message = {};
+	cell.sequence.store(tail + mMask + 1, std::memory_order_release);
+	mTail.store(tail + 1, std::memory_order_relaxed);
+
+	mReceived.fetch_add(1, std::memory_order_relaxed);
+	return message;
+}
+
+auto Channel::ReceiveBatch(std::vector< Message >& messages, const size_t max) -> size_t
+{
+	size_t tail = mTail.load(std::memory_order_relaxed);
+	size_t count = 0;
+
+	for (; count < max; ++count, ++tail) {
+		Cell& cell = mCells[ tail & mMask ];
+		if (cell.sequence.load(std::memory_order_acquire) != tail + 1) {
+			break;
+		}
+
+		messages.push_back(std::move(cell.message));
+		cell.message = {};
+		cell.sequence.store(tail + mMask + 1, std::memory_order_release);
+	}
+
+	mTail.store(tail, std::memory_order_relaxed);
+	mReceived.fetch_add(count, std::memory_order_relaxed);
+	return count;
+}
+
+auto Channel::GetSize() const -> size_t
+{
+	const size_t tail = mTail.load(std::memory_order_relaxed);
+	const size_t head = mHead.load(std::memory_order_relaxed);
+	return head > tail ? head - tail : 0;
+}
+
+auto Channel::GetStatistics() const -> ChannelStatistics
+{
+	return ChannelStatistics{
+		.sent = mSent.load(std::memory_order_relaxed),
+		.received = mReceived.load(std::memory_order_relaxed),
+		.rejected = mRejected.load(std::memory_order_relaxed),
+		.bytes = mBytes.load(std::memory_order_relaxed),
+	};
+}
+
+////////////////      Stack     ////////////////
+
+auto Stack< ChannelPtr >::Get(lua_State* L, const int32_t idx) -> ChannelPtr
+{
+	if (!Is(L, idx)) {
+		return nullptr;
+	}
+	return *static_cast< ChannelPtr* >(lua_touserdata(L, idx));
+}
+
+void Stack< ChannelPtr >::Push(lua_State* L, const ChannelPtr& channel)
+{
+	if (!channel) {
+		lua_pushnil(L);
+		return;
+	}
+
+	new (lua_newuserdata(L, sizeof(ChannelPtr))) ChannelPtr{ channel };
+	PushChannelMetatable(L);
+	lua_setmetatable(L, -2);
+}
+
+auto Stack< ChannelPtr >::Is(lua_State* L, const int32_t idx) -> bool
+{
+	if (lua_type(L, idx) != LUA_TUSERDATA || !lua_getmetatable(L, idx)) {
+		return false;
+	}
+
+	luaL_getmetatable(L, ChannelMetatable);
+	const bool is = lua_rawequal(L, -1, -2);
+	lua_pop(L, 2);
+	return is;
+}
+
+} // namespace Script
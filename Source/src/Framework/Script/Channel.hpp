@@ -0,0 +1,163 @@
+#ifndef FRAMEWORK_SCRIPT_CHANNEL_HPP
+#define FRAMEWORK_SCRIPT_CHANNEL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <Framework/Script/Engine.hpp>
+#include <Framework/Script/TypeRegistry.hpp>
+
+namespace Script
+{
+
+// A Lua value flattened to bytes so it can leave the engine it was read from.
+// Nil, booleans, numbers, strings and nested tables are copied, objects travel
+// by handle: the receiver gets a new userdata sharing ownership of the same instance.
+class Message final
+{
+public:
+	struct Object
+	{
+		std::shared_ptr< void > ownership = {};
+		TypeId type = nullptr;
+		void* pointer = nullptr;
+		std::string metatable = {};
+	};
+
+	// Returns nullptr on success, otherwise why the value can't be encoded.
+	[[nodiscard]] auto Encode(lua_State*, int32_t idx) -> const char*;
+	void Decode(lua_State*) const;
+
+	[[nodiscard]] inline auto GetSize() const -> size_t;
+
+private:
+	[[nodiscard]] auto EncodeValue(lua_State*, int32_t idx, uint32_t depth) -> const char*;
+	void DecodeValue(lua_State*, size_t& offset) const;
+
+private:
+	std::string mData = {};
+	std::vector< Object > mObjects = {};
+};
+
+struct ChannelStatistics
+{
+	uint64_t sent = 0;
+	uint64_t received = 0;
+	uint64_t rejected = 0;
+	uint64_t bytes = 0;
+};
+
+// Bounded lock-free queue for handing messages between engines living on different threads.
+// Any number of threads may send, only one thread at a time may receive. Sends never block,
+// a full channel rejects the message instead. Batches claim their slots with a single CAS.
+//
+// Scripts see the channel as an object:
+//   channel:Send(value) -> bool, channel:SendBatch({ ... }) -> count,
+//   channel:Receive() -> bool, value, channel:ReceiveBatch(max) -> { ... }, count,
+//   channel:Statistics() -> { sent, received, rejected, bytes }, #channel
+class Channel final
+{
+public:
+	explicit Channel(size_t capacity);
+	Channel(const Channel&) = delete;
+	Channel(Channel&&) = delete;
+	Channel& operator=(const Channel&) = delete;
+	Channel& operator=(Channel&&) = delete;
+	~Channel() = default;
+
+	[[nodiscard]] auto Send(Message message) -> bool;
+	// Sent messages are removed from the front of the vector, the rest did not fit.
+	[[nodiscard]] auto SendBatch(std::vector< Message >& messages) -> size_t;
+	[[nodiscard]] auto Receive() -> std::optional< Message >;
+	auto ReceiveBatch(std::vector< Message >& messages, size_t max) -> size_t;
+
+	template < typename Type >
+	[[nodiscard]] auto Send(const Engine*, const Type& value) -> bool;
+	template < typename Type >
+	[[nodiscard]] auto Receive(const Engine*) -> std::optional< Type >;
+
+	[[nodiscard]] inline auto GetCapacity() const -> size_t;
+	[[nodiscard]] auto GetSize() const -> size_t;
+	[[nodiscard]] auto GetStatistics() const -> ChannelStatistics;
+
+private:
+	struct Cell
+	{
+		std::atomic< size_t > sequence = 0;
+		Message message = {};
+	};
+
+	[[nodiscard]] auto Claim(size_t count, size_t& position) -> size_t;
+	void Publish(size_t position, Message&& message);
+
+private:
+	const size_t mMask = 0;
+	const std::unique_ptr< Cell[] > mCells = {};
+
+	alignas(64) std::atomic< size_t > mHead = 0;
+	alignas(64) std::atomic< size_t > mTail = 0;
+
+	alignas(64) std::atomic< uint64_t > mSent = 0;
+	std::atomic< uint64_t > mReceived = 0;
+	std::atomic< uint64_t > mRejected = 0;
+	std::atomic< uint64_t > mBytes = 0;
+};
+
+using ChannelPtr = std::shared_ptr< Channel >;
+
+auto Message::GetSize() const -> size_t
+{
+	return mData.size();
+}
+
+auto Channel::GetCapacity() const -> size_t
+{
+	return mMask + 1;
+}
+
+template < typename Type >
+auto Channel::Send(const Engine* engine, const Type& value) -> bool
+{
+	lua_State* L = engine->State();
+
+	Stack< Type >::Push(L, value);
+	Message message = {};
+	const char* error = message.Encode(L, -1);
+	lua_pop(L, 1);
+
+	if (error) {
+		throw std::string{ "<Script::Channel::Send> " } + error;
+	}
+	return Send(std::move(message));
+}
+
+template < typename Type >
+auto Channel::Receive(const Engine* engine) -> std::optional< Type >
+{
+	std::optional< Message > message = Receive();
+	if (!message) {
+		return {};
+	}
+
+	lua_State* L = engine->State();
+	message->Decode(L);
+	Type value = Stack< Type >::Get(L, -1);
+	lua_pop(L, 1);
+	return value;
+}
+
+template <>
+struct Stack< ChannelPtr >
+{
+	static ChannelPtr Get(lua_State* L, const int32_t idx);
+	static void Push(lua_State* L, const ChannelPtr& channel);
+	static bool Is(lua_State* L, const int32_t idx);
+};
+
+} // namespace Script
+
+#endif
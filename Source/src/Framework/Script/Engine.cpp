@@ -1,33 +1,144 @@
 #include <Framework/Script/Engine.hpp>
 
 #include <Framework/Script/Basic.hpp>
+#include <Framework/Script/Bundle.hpp>
+#include <Framework/Script/EventBus.hpp>
+#include <Framework/Script/JitControl.hpp>
 #include <Framework/Script/Metatable.hpp>
+#include <Framework/Script/Metrics.hpp>
+#include <Framework/Script/Reloader.hpp>
 #include <Framework/Script/Sandbox.hpp>
+#include <Framework/Script/Task.hpp>
+#include <Framework/Script/TraceDiagnostics.hpp>
 
 extern "C" {
 #include <lualib.h>
 }
 
+#include <algorithm>
+
 namespace Script
 {
 
-Engine::Engine()
+namespace
+{
+
+// Registry keys of the metatables set on _G and on the registry while libraries or metatables are pending.
+const char GlobalsHookKey = 0;
+const char RegistryHookKey = 0;
+
+struct LibraryEntry
+{
+	Library library = Library::None;
+	const char* name = nullptr;
+	lua_CFunction open = nullptr;
+};
+
+constexpr LibraryEntry Libraries[] = {
+	{ Library::Package, LUA_LOADLIBNAME, luaopen_package },
+	{ Library::Table, LUA_TABLIBNAME, luaopen_table },
+	{ Library::Io, LUA_IOLIBNAME, luaopen_io },
+	{ Library::Os, LUA_OSLIBNAME, luaopen_os },
+	{ Library::String, LUA_STRLIBNAME, luaopen_string },
+	{ Library::Math, LUA_MATHLIBNAME, luaopen_math },
+	{ Library::Debug, LUA_DBLIBNAME, luaopen_debug },
+	{ Library::Bit, LUA_BITLIBNAME, luaopen_bit },
+	{ Library::Jit, LUA_JITLIBNAME, luaopen_jit },
+};
+
+void OpenStandardLibrary(lua_State* L, const char* name, const lua_CFunction open)
+{
+	lua_pushcfunction(L, open);
+	lua_pushstring(L, name);
+	lua_call(L, 1, 0);
+}
+
+void InstallHook(lua_State* L, const int32_t idx, const char* key, const lua_CFunction index, const void* engine)
+{
+	// Installed already, or the table has a metatable of its own which is left alone.
+	if (lua_getmetatable(L, idx)) {
+		lua_pop(L, 1);
+		return;
+	}
+
+	lua_createtable(L, 0, 1);
+	lua_pushlightuserdata(L, const_cast< void* >(engine));
+	lua_pushcclosure(L, index, 1);
+	lua_setfield(L, -2, "__index");
+
+	lua_pushlightuserdata(L, const_cast< char* >(key));
+	lua_pushvalue(L, -2);
+	lua_rawset(L, LUA_REGISTRYINDEX);
+	lua_setmetatable(L, idx);
+}
+
+void RemoveHook(lua_State* L, const int32_t idx, const char* key)
+{
+	lua_pushlightuserdata(L, const_cast< char* >(key));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	if (!lua_isnil(L, -1) && lua_getmetatable(L, idx)) {
+		if (lua_rawequal(L, -1, -2)) {
+			lua_pushnil(L);
+			lua_setmetatable(L, idx);
+		}
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 1);
+
+	lua_pushlightuserdata(L, const_cast< char* >(key));
+	lua_pushnil(L);
+	lua_rawset(L, LUA_REGISTRYINDEX);
+}
+
+// Integer keys of the luaL_ref table at idx that are not on its free list.
+auto CountReferences(lua_State* L, const int32_t idx) -> uint64_t
+{
+	const int32_t table = (idx < 0 && idx > LUA_REGISTRYINDEX) ? lua_gettop(L) + idx + 1 : idx;
+
+	uint64_t count = 0;
+	lua_pushnil(L);
+	while (lua_next(L, table)) {
+		lua_pop(L, 1);
+		count += (lua_type(L, -1) == LUA_TNUMBER && lua_tointeger(L, -1) > 0) ? 1 : 0;
+	}
+
+	// The free list starts at index 0 and links the released indices through their values.
+	lua_rawgeti(L, table, 0);
+	while (lua_tointeger(L, -1) > 0 && count > 0) {
+		const int32_t next = static_cast< int32_t >(lua_tointeger(L, -1));
+		lua_pop(L, 1);
+		lua_rawgeti(L, table, next);
+		count--;
+	}
+	lua_pop(L, 1);
+	return count;
+}
+
+} // namespace
+
+Engine::Engine(const EngineOptions& options)
 	: L(luaL_newstate())
+	, mCounters(new RuntimeCounters{})
 {
-	luaL_openlibs(L);
+	OpenLibraries(options);
 
 	Utils::WeakRefCreate(L);
+	Utils::CountersCreate(L, mCounters.get());
 }
 
 Engine::~Engine()
 {
+	mProfiler.reset();
+	mEventBus.reset();
+	mJit.reset();
+	mCounters->closing = true;
 	lua_close(L);
 	L = nullptr;
 }
 
 auto Engine::Call(const int32_t nargs, const int32_t nresults, const int32_t ctx) const -> bool
 {
-	if (lua_pcall(L, nargs, nresults, ctx)) {
+	if (Utils::ProtectedCall(L, nargs, nresults, ctx)) {
 		throw std::string{ lua_tostring(L, -1) };
 	}
 	return true;
@@ -82,6 +193,154 @@ void Engine::CollectGarbage()
 	lua_gc(L, LUA_GCCOLLECT, 0);
 }
 
+void Engine::StartProfiler(const std::chrono::milliseconds interval)
+{
+	if (!mProfiler) {
+		mProfiler = std::unique_ptr< Profiler >{ new Profiler{ L } };
+	}
+	mProfiler->Start(interval);
+}
+
+auto Engine::StopProfiler() -> Profile
+{
+	if (!mProfiler) {
+		return {};
+	}
+	return mProfiler->Stop();
+}
+
+void Engine::SetIdentityCache(const bool enabled) const
+{
+	Utils::IdentityCacheCreate(L, enabled);
+}
+
+auto Engine::HasIdentityCache() const -> bool
+{
+	return Utils::IdentityCacheExists(L);
+}
+
+void Engine::AddBundle(const BundlePtr& bundle) const
+{
+	Bundle::Install(L, bundle);
+}
+
+void Engine::OpenLibraries(const EngineOptions& options)
+{
+	OpenStandardLibrary(L, "", luaopen_base);
+
+	for (const LibraryEntry& entry : Libraries) {
+		if ((options.libraries & entry.library) == Library::None) {
+			continue;
+		}
+
+		if (options.lazyLibraries && entry.library != Library::String && entry.library != Library::Jit) {
+			mPendingLibraries = mPendingLibraries | entry.library;
+		} else {
+			OpenStandardLibrary(L, entry.name, entry.open);
+		}
+	}
+
+	if ((options.libraries & Library::Ffi) != Library::None) {
+		luaL_findtable(L, LUA_REGISTRYINDEX, "_PRELOAD", 1);
+		lua_pushcfunction(L, luaopen_ffi);
+		lua_setfield(L, -2, LUA_FFILIBNAME);
+		lua_pop(L, 1);
+	}
+
+	if (mPendingLibraries != Library::None) {
+		InstallLazyHooks();
+	}
+}
+
+void Engine::InstallLazyHooks() const
+{
+	InstallHook(L, LUA_GLOBALSINDEX, &GlobalsHookKey, GlobalIndex, this);
+	InstallHook(L, LUA_REGISTRYINDEX, &RegistryHookKey, RegistryIndex, this);
+}
+
+void Engine::RemoveLazyHooks() const
+{
+	if (mPendingLibraries != Library::None || !mDeferredMetatables.empty()) {
+		return;
+	}
+
+	RemoveHook(L, LUA_GLOBALSINDEX, &GlobalsHookKey);
+	RemoveHook(L, LUA_REGISTRYINDEX, &RegistryHookKey);
+}
+
+auto Engine::OpenLibrary(const std::string_view name) const -> bool
+{
+	for (const LibraryEntry& entry : Libraries) {
+		const bool matches = (name == entry.name) || (entry.library == Library::Package && (name == "require" || name == "module"));
+		if (!matches || (mPendingLibraries & entry.library) == Library::None) {
+			continue;
+		}
+
+		mPendingLibraries = static_cast< Library >(static_cast< uint32_t >(mPendingLibraries) & ~static_cast< uint32_t >(entry.library));
+		OpenStandardLibrary(L, entry.name, entry.open);
+		RemoveLazyHooks();
+		return true;
+	}
+	return false;
+}
+
+auto Engine::MaterializeMetatable(const std::string_view name) const -> bool
+{
+	const auto it = mDeferredMetatables.find(std::string{ name });
+	if (it == mDeferredMetatables.end()) {
+		return false;
+	}
+
+	const MetatableRegistrar registrar = std::move(it->second);
+	mDeferredMetatables.erase(it);
+	registrar(*this);
+	RemoveLazyHooks();
+	return true;
+}
+
+auto Engine::GlobalIndex(lua_State* L) -> int32_t
+{
+	if (lua_type(L, 2) == LUA_TSTRING) {
+		const Engine* engine = static_cast< const Engine* >(lua_touserdata(L, lua_upvalueindex(1)));
+		size_t length = 0;
+		const char* name = lua_tolstring(L, 2, &length);
+
+		const std::string_view key{ name, length };
+		if (engine->OpenLibrary(key) || engine->MaterializeMetatable(key)) {
+			lua_pushvalue(L, 2);
+			lua_rawget(L, 1);
+			return 1;
+		}
+	}
+
+	lua_pushnil(L);
+	return 1;
+}
+
+auto Engine::RegistryIndex(lua_State* L) -> int32_t
+{
+	if (lua_type(L, 2) == LUA_TSTRING) {
+		const Engine* engine = static_cast< const Engine* >(lua_touserdata(L, lua_upvalueindex(1)));
+		size_t length = 0;
+		const char* name = lua_tolstring(L, 2, &length);
+
+		if (engine->MaterializeMetatable(std::string_view{ name, length })) {
+			lua_pushvalue(L, 2);
+			lua_rawget(L, 1);
+			return 1;
+		}
+	}
+
+	lua_pushnil(L);
+	return 1;
+}
+
+void Engine::DeferMetatable(const std::string& name, MetatableRegistrar registrar)
+{
+	mDeferredMetatables.insert_or_assign(name, std::move(registrar));
+	InstallLazyHooks();
+}
+
 void Engine::RemoveGlobal(const std::string& name) const
 {
 	lua_pushnil(L);
@@ -105,11 +364,13 @@ auto Engine::operator[](const std::string& name) const -> Reference
 
 auto Engine::GetMetatable(const std::string_view& name) const -> MetatablePtr
 {
+	MaterializeMetatable(name);
 	return MetatablePtr{ new Metatable{ this, name } };
 }
 
 auto Engine::GetMetatable(const std::string_view& name, const std::string_view& parentName) const -> MetatablePtr
 {
+	MaterializeMetatable(name);
 	return MetatablePtr{ new Metatable{ this, name, parentName } };
 }
 
@@ -118,4 +379,75 @@ auto Engine::GetSandbox(const std::string_view& name) const -> SandboxPtr
 	return SandboxPtr{ new Sandbox{ this, name } };
 }
 
+auto Engine::CreateTask(const std::string& script) const -> TaskPtr
+{
+	return TaskPtr{ new Task{ this, script } };
+}
+
+auto Engine::CreateReloader() const -> ReloaderPtr
+{
+	return ReloaderPtr{ new Reloader{ this } };
+}
+
+auto Engine::GetEventBus() const -> EventBusPtr
+{
+	if (!mEventBus) {
+		mEventBus = EventBusPtr{ new EventBus{ this } };
+	}
+	return mEventBus;
+}
+
+auto Engine::Jit() const -> JitControlPtr
+{
+	if (!mJit) {
+		mJit = JitControlPtr{ new JitControl{ this } };
+	}
+	return mJit;
+}
+
+auto Engine::CreateTraceDiagnostics() const -> TraceDiagnosticsPtr
+{
+	return TraceDiagnosticsPtr{ new TraceDiagnostics{ this } };
+}
+
+auto Engine::Metrics() const -> EngineMetrics
+{
+	EngineMetrics metrics = {
+		.heapBytes = static_cast< uint64_t >(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + static_cast< uint64_t >(lua_gc(L, LUA_GCCOUNTB, 0)),
+		.strongReferences = CountReferences(L, LUA_REGISTRYINDEX),
+		.boundFunctions = static_cast< uint64_t >(std::max< int64_t >(mCounters->functions, 0)),
+		.protectedCalls = mCounters->calls,
+		.errors = mCounters->errors,
+		.gcCycles = mCounters->gcCycles,
+	};
+
+	lua_getglobal(L, "__ref");
+	if (lua_istable(L, -1)) {
+		metrics.weakReferences = CountReferences(L, -1);
+	}
+	lua_pop(L, 1);
+
+	// Metatables are only known by address, their names are the registry keys they are stored under.
+	std::unordered_map< const void*, std::string > names = {};
+	lua_pushnil(L);
+	while (lua_next(L, LUA_REGISTRYINDEX)) {
+		if (lua_type(L, -2) == LUA_TSTRING && lua_istable(L, -1)) {
+			names.emplace(lua_topointer(L, -1), lua_tostring(L, -2));
+		}
+		lua_pop(L, 1);
+	}
+
+	for (const auto& [ metatable, count ] : mCounters->objects) {
+		const auto it = names.find(metatable);
+		if (count > 0 && it != names.end()) {
+			metrics.objects[ it->second ] += static_cast< uint64_t >(count);
+		}
+	}
+
+	if (mJit) {
+		metrics.jit = mJit->GetStatistics();
+	}
+	return metrics;
+}
+
 } // namespace Script
@@ -1,22 +1,74 @@
 #ifndef FRAMEWORK_SCRIPT_SCRIPTENGINE_HPP
 #define FRAMEWORK_SCRIPT_SCRIPTENGINE_HPP
 
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
+#include <Framework/Script/Key.hpp>
+#include <Framework/Script/Profiler.hpp>
 #include <Framework/Script/Reference.hpp>
 #include <Framework/Script/Stack/Stack.hpp>
 
 namespace Script
 {
 
+using BundlePtr = std::shared_ptr< class Bundle >;
+using EventBusPtr = std::shared_ptr< class EventBus >;
+using JitControlPtr = std::shared_ptr< class JitControl >;
 using MetatablePtr = std::shared_ptr< class Metatable >;
+using ReloaderPtr = std::shared_ptr< class Reloader >;
 using SandboxPtr = std::shared_ptr< class Sandbox >;
+using TaskPtr = std::shared_ptr< class Task >;
+using TraceDiagnosticsPtr = std::shared_ptr< class TraceDiagnostics >;
+
+struct EngineMetrics;
+
+enum class Library : uint32_t {
+	None = 0,
+	Package = 1 << 0,
+	Table = 1 << 1,
+	Io = 1 << 2,
+	Os = 1 << 3,
+	String = 1 << 4,
+	Math = 1 << 5,
+	Debug = 1 << 6,
+	Bit = 1 << 7,
+	// Opening it is also what turns the trace compiler on.
+	Jit = 1 << 8,
+	// Preloaded for require("ffi"), raw object pointers use ffi either way.
+	Ffi = 1 << 9,
+	All = (1 << 10) - 1,
+};
+
+constexpr auto operator|(const Library left, const Library right) -> Library
+{
+	return static_cast< Library >(static_cast< uint32_t >(left) | static_cast< uint32_t >(right));
+}
+
+constexpr auto operator&(const Library left, const Library right) -> Library
+{
+	return static_cast< Library >(static_cast< uint32_t >(left) & static_cast< uint32_t >(right));
+}
+
+struct EngineOptions
+{
+	// The base library is always opened.
+	Library libraries = Library::All;
+	// Opens libraries on first access of their global. String and Jit stay eager,
+	// string methods need the string metatable and the compiler is enabled by the jit library.
+	bool lazyLibraries = false;
+};
 
 class Engine final
 {
 public:
-	explicit Engine();
+	using MetatableRegistrar = std::function< void(const Engine&) >;
+
+	explicit Engine(const EngineOptions& options = {});
 	Engine(const Engine&) = delete;
 	Engine(Engine&&) = delete;
 	Engine& operator=(const Engine&) = delete;
@@ -37,24 +89,74 @@ public:
 
 	void CollectGarbage();
 
+	// Re-pushing a live shared object returns its existing userdata instead of creating a new one.
+	void SetIdentityCache(bool enabled) const;
+	[[nodiscard]] auto HasIdentityCache() const -> bool;
+
+	// Lets require() resolve modules from the bundle before probing package.path.
+	void AddBundle(const BundlePtr& bundle) const;
+
+	void StartProfiler(std::chrono::milliseconds interval = std::chrono::milliseconds{ 10 });
+	auto StopProfiler() -> Profile;
+
 	template < typename Type >
 	void SetGlobal(const std::string& name, const Type& value) const;
 	void RemoveGlobal(const std::string& name) const;
 	[[nodiscard]] auto GetGlobal() const -> Reference;
 	[[nodiscard]] auto GetGlobal(const std::string& name) const -> Reference;
 	[[nodiscard]] auto operator[](const std::string& name) const -> Reference;
+	template < FixedString Name >
+	[[nodiscard]] auto operator[](Key< Name >) const -> Reference;
 
+	// Runs registrar the first time the metatable is needed: when an object of the type is pushed,
+	// when it is read as a global or looked up with GetMetatable / luaL_getmetatable.
+	void DeferMetatable(const std::string& name, MetatableRegistrar registrar);
 	[[nodiscard]] auto GetMetatable(const std::string_view& name) const -> MetatablePtr;
 	[[nodiscard]] auto GetMetatable(const std::string_view& name, const std::string_view& parentName) const -> MetatablePtr;
 	[[nodiscard]] auto GetSandbox(const std::string_view& name) const -> SandboxPtr;
+	[[nodiscard]] auto CreateTask(const std::string& script) const -> TaskPtr;
+	[[nodiscard]] auto CreateReloader() const -> ReloaderPtr;
+	// Created on first use, also installs the EventBus global.
+	[[nodiscard]] auto GetEventBus() const -> EventBusPtr;
+	// Created on first use, trace statistics are collected from then on.
+	[[nodiscard]] auto Jit() const -> JitControlPtr;
+	// Records trace aborts while the returned collector exists.
+	[[nodiscard]] auto CreateTraceDiagnostics() const -> TraceDiagnosticsPtr;
+	// Walks the registry and __ref, cost grows with the number of references.
+	[[nodiscard]] auto Metrics() const -> EngineMetrics;
 
 private:
 	[[nodiscard]] auto Call(int32_t nargs = 0, int32_t nresults = 0, int32_t ctx = 0) const -> bool;
 
+	void OpenLibraries(const EngineOptions& options);
+	void InstallLazyHooks() const;
+	void RemoveLazyHooks() const;
+	auto OpenLibrary(std::string_view name) const -> bool;
+	auto MaterializeMetatable(std::string_view name) const -> bool;
+
+	static auto GlobalIndex(lua_State*) -> int32_t;
+	static auto RegistryIndex(lua_State*) -> int32_t;
+
 private:
 	lua_State* L = {};
+	// Released after the state, collectors still count while it closes.
+	std::unique_ptr< RuntimeCounters > mCounters = {};
+	std::unique_ptr< Profiler > mProfiler = {};
+	mutable EventBusPtr mEventBus = {};
+	mutable JitControlPtr mJit = {};
+
+	mutable Library mPendingLibraries = Library::None;
+	mutable std::unordered_map< std::string, MetatableRegistrar > mDeferredMetatables = {};
 };
 
+template < FixedString Name >
+auto Engine::operator[](const Key< Name >) const -> Reference
+{
+	Key< Name >::Push(L);
+	lua_gettable(L, LUA_GLOBALSINDEX);
+	return Reference{ L, -1, true };
+}
+
 auto Engine::State() const -> lua_State*
 {
 	return L;
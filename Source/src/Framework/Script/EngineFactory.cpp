@@ -0,0 +1,200 @@
+#include <Framework/Script/EngineFactory.hpp>
+
+#include <Framework/Script/Sandbox.hpp>
+
+extern "C" {
+#include <lauxlib.h>
+}
+
+namespace Script
+{
+
+namespace
+{
+
+auto DumpWriter(lua_State*, const void* data, const size_t size, void* output) -> int32_t
+{
+	static_cast< std::string* >(output)->append(static_cast< const char* >(data), size);
+	return 0;
+}
+
+// Pops the function loaded on top of L and returns its bytecode, on a load error throws its message.
+auto Dump(lua_State* L, const int32_t status, const std::string& context) -> std::string
+{
+	if (status) {
+		std::string error = lua_tostring(L, -1);
+		lua_close(L);
+		throw context + " " + error;
+	}
+
+	std::string bytecode = {};
+	lua_dump(L, DumpWriter, &bytecode);
+	lua_close(L);
+	return bytecode;
+}
+
+} // namespace
+
+EngineFactory::EngineFactory(const EngineOptions& options)
+	: mOptions(options)
+{
+}
+
+EngineFactory::~EngineFactory()
+{
+	StopPool();
+}
+
+auto EngineFactory::AddBinding(Binding binding) -> EngineFactory*
+{
+	CheckMutable("<Script::EngineFactory::AddBinding>");
+	mSteps.push_back(Step{ .binding = std::move(binding) });
+	return this;
+}
+
+auto EngineFactory::AddChunk(const std::string& name, const std::string& script, const std::string& sandbox) -> EngineFactory*
+{
+	CheckMutable("<Script::EngineFactory::AddChunk>");
+
+	const std::string chunkname = "@" + name;
+	lua_State* L = luaL_newstate();
+	const int32_t status = luaL_loadbuffer(L, script.data(), script.size(), chunkname.c_str());
+
+	mSteps.push_back(Step{
+		.name = chunkname,
+		.bytecode = Dump(L, status, "<Script::EngineFactory::AddChunk>"),
+		.sandbox = sandbox,
+	});
+	return this;
+}
+
+auto EngineFactory::AddFile(const std::string& filename, const std::string& sandbox) -> EngineFactory*
+{
+	CheckMutable("<Script::EngineFactory::AddFile>");
+
+	lua_State* L = luaL_newstate();
+	const int32_t status = luaL_loadfile(L, filename.c_str());
+
+	mSteps.push_back(Step{
+		.name = "@" + filename,
+		.bytecode = Dump(L, status, "<Script::EngineFactory::AddFile>"),
+		.sandbox = sandbox,
+	});
+	return this;
+}
+
+auto EngineFactory::Create() const -> EnginePtr
+{
+	EnginePtr engine{ new Engine{ mOptions } };
+	lua_State* L = engine->State();
+
+	for (const Step& step : mSteps) {
+		if (step.binding) {
+			step.binding(*engine);
+			continue;
+		}
+
+		if (luaL_loadbuffer(L, step.bytecode.data(), step.bytecode.size(), step.name.c_str()) == 0) {
+			if (!step.sandbox.empty()) {
+				static_cast< void >(engine->GetSandbox(step.sandbox));
+				lua_getglobal(L, step.sandbox.c_str());
+				lua_setfenv(L, -2);
+			}
+			if (lua_pcall(L, 0, 0, 0) == 0) {
+				continue;
+			}
+		}
+
+		std::string error = lua_tostring(L, -1);
+		lua_pop(L, 1);
+		throw "<Script::EngineFactory::Create> " + error;
+	}
+	return engine;
+}
+
+void EngineFactory::StartPool(const size_t size)
+{
+	StopPool();
+	if (size == 0) {
+		return;
+	}
+
+	mPoolSize = size;
+	mRunning = true;
+	mWorker = std::thread{ &EngineFactory::Fill, this };
+}
+
+void EngineFactory::StopPool()
+{
+	{
+		const std::lock_guard< std::mutex > lock{ mMutex };
+		mRunning = false;
+	}
+	mCondition.notify_all();
+
+	if (mWorker.joinable()) {
+		mWorker.join();
+	}
+
+	const std::lock_guard< std::mutex > lock{ mMutex };
+	mPool.clear();
+	mPoolSize = 0;
+	mError.clear();
+}
+
+auto EngineFactory::Acquire() -> EnginePtr
+{
+	{
+		const std::lock_guard< std::mutex > lock{ mMutex };
+		if (!mPool.empty()) {
+			EnginePtr engine = std::move(mPool.front());
+			mPool.pop_front();
+			mCondition.notify_all();
+			return engine;
+		}
+	}
+	return Create();
+}
+
+auto EngineFactory::GetPooled() const -> size_t
+{
+	const std::lock_guard< std::mutex > lock{ mMutex };
+	if (!mError.empty()) {
+		throw "<Script::EngineFactory::GetPooled> Pool stopped: " + mError;
+	}
+	return mPool.size();
+}
+
+void EngineFactory::CheckMutable(const std::string& context) const
+{
+	if (mWorker.joinable()) {
+		throw context + " Manifest can't change while the pool is running";
+	}
+}
+
+void EngineFactory::Fill()
+{
+	std::unique_lock< std::mutex > lock{ mMutex };
+	while (mRunning) {
+		if (mPool.size() >= mPoolSize) {
+			mCondition.wait(lock);
+			continue;
+		}
+
+		lock.unlock();
+		EnginePtr engine = {};
+		try {
+			engine = Create();
+		} catch (const std::string& error) {
+			// Acquire() falls back to Create() and reports the error to its caller as well.
+			lock.lock();
+			mError = error;
+			return;
+		}
+		lock.lock();
+
+		mPool.push_back(std::move(engine));
+	}
+}
+
+} // namespace Script
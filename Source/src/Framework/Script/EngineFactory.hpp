@@ -0,0 +1,93 @@
+#ifndef FRAMEWORK_SCRIPT_ENGINEFACTORY_HPP
+#define FRAMEWORK_SCRIPT_ENGINEFACTORY_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Framework/Script/Engine.hpp>
+#include <Framework/Script/TypeRegistry.hpp>
+
+namespace Script
+{
+
+using EnginePtr = std::shared_ptr< Engine >;
+
+// Records how an engine is initialised once and replays it for every new engine:
+//   bindings - C++ callbacks registering metatables, globals and sandboxes
+//   chunks   - scripts compiled to bytecode when added, only loaded and run on replay
+// Type registrations are process wide and happen once when added.
+// With a pool, a background thread keeps ready engines so Acquire() does not wait for initialisation.
+// Bindings then run on the pool thread and the manifest can't change until the pool is stopped.
+class EngineFactory final
+{
+public:
+	using Binding = std::function< void(Engine&) >;
+
+	explicit EngineFactory(const EngineOptions& options = {});
+	EngineFactory(const EngineFactory&) = delete;
+	EngineFactory(EngineFactory&&) = delete;
+	EngineFactory& operator=(const EngineFactory&) = delete;
+	EngineFactory& operator=(EngineFactory&&) = delete;
+	~EngineFactory();
+
+	template < class Derived, class... Bases >
+	auto AddType() -> EngineFactory*;
+	auto AddBinding(Binding binding) -> EngineFactory*;
+	// Chunks run in the global environment or, when sandbox is given, in that sandbox.
+	auto AddChunk(const std::string& name, const std::string& script, const std::string& sandbox = {}) -> EngineFactory*;
+	auto AddFile(const std::string& filename, const std::string& sandbox = {}) -> EngineFactory*;
+
+	[[nodiscard]] auto Create() const -> EnginePtr;
+
+	void StartPool(size_t size);
+	void StopPool();
+	// Takes a pooled engine, creates one in place when the pool is empty.
+	[[nodiscard]] auto Acquire() -> EnginePtr;
+	// Throws the error that stopped the pool thread, StopPool() clears it.
+	[[nodiscard]] auto GetPooled() const -> size_t;
+
+private:
+	struct Step
+	{
+		Binding binding = {};
+		std::string name = {};
+		std::string bytecode = {};
+		std::string sandbox = {};
+	};
+
+	void CheckMutable(const std::string& context) const;
+	void Fill();
+
+private:
+	EngineOptions mOptions = {};
+	std::vector< Step > mSteps = {};
+
+	mutable std::mutex mMutex = {};
+	std::condition_variable mCondition = {};
+	std::deque< EnginePtr > mPool = {};
+	std::thread mWorker = {};
+	size_t mPoolSize = 0;
+	bool mRunning = false;
+	std::string mError = {};
+};
+
+using EngineFactoryPtr = std::shared_ptr< EngineFactory >;
+
+template < class Derived, class... Bases >
+auto EngineFactory::AddType() -> EngineFactory*
+{
+	// The pool thread reads the registry while it creates engines.
+	CheckMutable("<Script::EngineFactory::AddType>");
+	TypeRegistry::Register< Derived, Bases... >();
+	return this;
+}
+
+} // namespace Script
+
+#endif
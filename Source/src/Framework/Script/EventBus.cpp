@@ -0,0 +1,309 @@
+#include <Framework/Script/EventBus.hpp>
+
+#include <Framework/Script/Engine.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace Script
+{
+
+EventBus::EventBus(const Engine* engine)
+	: L(engine->State())
+{
+	lua_newtable(L);
+	mTable = Reference{ L, -1, true };
+
+	const luaL_Reg functions[] = {
+		{ "On", LuaOn },
+		{ "Once", LuaOnce },
+		{ "Off", LuaOff },
+		{ "Emit", LuaEmit },
+	};
+
+	lua_createtable(L, 0, 4);
+	for (const luaL_Reg& function : functions) {
+		lua_pushlightuserdata(L, this);
+		lua_pushcclosure(L, function.func, 1);
+		lua_setfield(L, -2, function.name);
+	}
+	lua_setglobal(L, "EventBus");
+}
+
+auto EventBus::GetEventId(const std::string& name) -> EventId
+{
+	const auto [ it, inserted ] = mEventIds.try_emplace(name, static_cast< EventId >(mEvents.size()));
+	if (inserted) {
+		mEvents.push_back(Event{ .name = name });
+
+		mTable.Push();
+		lua_newtable(L);
+		lua_rawseti(L, -2, static_cast< int32_t >(it->second) + 1);
+		lua_pop(L, 1);
+	}
+	return it->second;
+}
+
+auto EventBus::On(const EventId event, const Reference& handler, const int32_t priority, const bool once) -> HandlerId
+{
+	if (event >= mEvents.size()) {
+		throw std::string{ "<Script::EventBus::On> Unknown event" };
+	}
+
+	handler.Push();
+	if (!lua_isfunction(L, -1)) {
+		lua_pop(L, 1);
+		throw std::string{ "<Script::EventBus::On> Handler is not a function" };
+	}
+
+	const HandlerId id = Add(L, event, lua_gettop(L), priority, once);
+	lua_pop(L, 1);
+	return id;
+}
+
+auto EventBus::On(const std::string& name, const Reference& handler, const int32_t priority, const bool once) -> HandlerId
+{
+	return On(GetEventId(name), handler, priority, once);
+}
+
+auto EventBus::Off(const HandlerId handler) -> bool
+{
+	return Remove(L, handler);
+}
+
+auto EventBus::GetHandlerCount(const EventId event) const -> size_t
+{
+	if (event >= mEvents.size()) {
+		return 0;
+	}
+
+	const std::vector< Handler >& handlers = mEvents[ event ].handlers;
+	return static_cast< size_t >(std::count_if(handlers.begin(), handlers.end(), [](const Handler& handler) { return !handler.removed; }));
+}
+
+void EventBus::SetErrorCallback(ErrorCallback callback)
+{
+	mErrorCallback = std::move(callback);
+}
+
+auto EventBus::Add(lua_State* L, const EventId event, const int32_t function, const int32_t priority, const bool once) -> HandlerId
+{
+	const Handler handler{
+		.id = mNextHandler++,
+		.priority = priority,
+		.once = once,
+	};
+	mHandlers.emplace(handler.id, event);
+
+	PushHandlers(L, event);
+	const int32_t table = lua_gettop(L);
+
+	Event& entry = mEvents[ event ];
+	const size_t size = entry.handlers.size();
+
+	// While dispatching indices must stay stable, the handler is appended and sorted in by Compact.
+	size_t position = size;
+	if (entry.depth == 0) {
+		const auto it = std::find_if(entry.handlers.begin(), entry.handlers.end(), [ priority ](const Handler& other) {
+			return other.priority < priority;
+		});
+		position = static_cast< size_t >(it - entry.handlers.begin());
+	} else {
+		entry.dirty = true;
+	}
+
+	for (size_t i = size; i > position; --i) {
+		lua_rawgeti(L, table, static_cast< int32_t >(i));
+		lua_rawseti(L, table, static_cast< int32_t >(i) + 1);
+	}
+	lua_pushvalue(L, function);
+	lua_rawseti(L, table, static_cast< int32_t >(position) + 1);
+	lua_pop(L, 1);
+
+	entry.handlers.insert(entry.handlers.begin() + static_cast< std::ptrdiff_t >(position), handler);
+	return handler.id;
+}
+
+auto EventBus::Remove(lua_State* L, const HandlerId handler) -> bool
+{
+	const auto it = mHandlers.find(handler);
+	if (it == mHandlers.end()) {
+		return false;
+	}
+
+	const EventId event = it->second;
+	mHandlers.erase(it);
+
+	for (Handler& entry : mEvents[ event ].handlers) {
+		if (entry.id == handler) {
+			entry.removed = true;
+			break;
+		}
+	}
+
+	mEvents[ event ].dirty = true;
+	if (mEvents[ event ].depth == 0) {
+		Compact(L, event);
+	}
+	return true;
+}
+
+auto EventBus::Dispatch(lua_State* L, const EventId event, const int32_t nargs, std::string& error) -> size_t
+{
+	const int32_t base = lua_gettop(L) - nargs;
+	luaL_checkstack(L, nargs + 2, "<Script::EventBus::Emit> stack overflow");
+
+	PushHandlers(L, event);
+	const int32_t table = lua_gettop(L);
+
+	mEvents[ event ].depth++;
+	const size_t size = mEvents[ event ].handlers.size();
+
+	const auto Leave = [ this, L, event, base ]() {
+		lua_settop(L, base);
+		if (--mEvents[ event ].depth == 0 && mEvents[ event ].dirty) {
+			Compact(L, event);
+		}
+	};
+
+	RuntimeCounters* counters = Utils::GetCounters(L);
+	size_t called = 0;
+	for (size_t i = 0; i < size; ++i) {
+		// Handlers may add events or handlers, entries are looked up again on every iteration.
+		Handler& handler = mEvents[ event ].handlers[ i ];
+		if (handler.removed) {
+			continue;
+		}
+		if (handler.once) {
+			handler.removed = true;
+			mEvents[ event ].dirty = true;
+			mHandlers.erase(handler.id);
+		}
+
+		lua_rawgeti(L, table, static_cast< int32_t >(i) + 1);
+		for (int32_t n = 1; n <= nargs; ++n) {
+			lua_pushvalue(L, base + n);
+		}
+		called++;
+
+		if (Utils::ProtectedCall(L, counters, nargs, 0, 0)) {
+			const char* message = lua_tostring(L, -1);
+			const std::string description = message ? message : "(error object is not a string)";
+			lua_pop(L, 1);
+
+			if (mErrorCallback) {
+				try {
+					mErrorCallback(mEvents[ event ].name, description);
+				} catch (...) {
+					Leave();
+					throw;
+				}
+			} else if (error.empty()) {
+				error = description;
+			}
+		}
+	}
+
+	Leave();
+	return called;
+}
+
+auto EventBus::Dispatch(const EventId event, const int32_t nargs) -> size_t
+{
+	std::string error = {};
+	const size_t called = Dispatch(L, event, nargs, error);
+	if (!error.empty()) {
+		throw "<Script::EventBus::Emit> " + error;
+	}
+	return called;
+}
+
+void EventBus::PushHandlers(lua_State* L, const EventId event) const
+{
+	Utils::StrongRefGet(L, mTable.GetId());
+	lua_rawgeti(L, -1, static_cast< int32_t >(event) + 1);
+	lua_remove(L, -2);
+}
+
+void EventBus::Compact(lua_State* L, const EventId event)
+{
+	Event& entry = mEvents[ event ];
+
+	std::vector< std::pair< Handler, int32_t > > handlers = {};
+	handlers.reserve(entry.handlers.size());
+	for (size_t i = 0; i < entry.handlers.size(); ++i) {
+		if (!entry.handlers[ i ].removed) {
+			handlers.emplace_back(entry.handlers[ i ], static_cast< int32_t >(i) + 1);
+		}
+	}
+	std::stable_sort(handlers.begin(), handlers.end(), [](const auto& left, const auto& right) {
+		return left.first.priority > right.first.priority;
+	});
+
+	Utils::StrongRefGet(L, mTable.GetId());
+	lua_rawgeti(L, -1, static_cast< int32_t >(event) + 1);
+	lua_createtable(L, static_cast< int32_t >(handlers.size()), 0);
+
+	entry.handlers.clear();
+	for (const auto& [ handler, index ] : handlers) {
+		lua_rawgeti(L, -2, index);
+		lua_rawseti(L, -2, static_cast< int32_t >(entry.handlers.size()) + 1);
+		entry.handlers.push_back(handler);
+	}
+	entry.dirty = false;
+
+	lua_rawseti(L, -3, static_cast< int32_t >(event) + 1);
+	lua_pop(L, 2);
+}
+
+auto EventBus::LuaOn(lua_State* L) -> int32_t
+{
+	return LuaAdd(L, false);
+}
+
+auto EventBus::LuaOnce(lua_State* L) -> int32_t
+{
+	return LuaAdd(L, true);
+}
+
+auto EventBus::LuaAdd(lua_State* L, const bool once) -> int32_t
+{
+	EventBus* bus = static_cast< EventBus* >(lua_touserdata(L, lua_upvalueindex(1)));
+	const std::string name = luaL_checkstring(L, 1);
+	luaL_checktype(L, 2, LUA_TFUNCTION);
+	const int32_t priority = static_cast< int32_t >(luaL_optinteger(L, 3, 0));
+
+	lua_pushnumber(L, static_cast< lua_Number >(bus->Add(L, bus->GetEventId(name), 2, priority, once)));
+	return 1;
+}
+
+auto EventBus::LuaOff(lua_State* L) -> int32_t
+{
+	EventBus* bus = static_cast< EventBus* >(lua_touserdata(L, lua_upvalueindex(1)));
+	lua_pushboolean(L, bus->Remove(L, static_cast< HandlerId >(luaL_checknumber(L, 1))));
+	return 1;
+}
+
+auto EventBus::LuaEmit(lua_State* L) -> int32_t
+{
+	EventBus* bus = static_cast< EventBus* >(lua_touserdata(L, lua_upvalueindex(1)));
+	size_t length = 0;
+	const char* name = luaL_checklstring(L, 1, &length);
+
+	const auto it = bus->mEventIds.find(std::string{ name, length });
+	if (it == bus->mEventIds.end()) {
+		lua_pushinteger(L, 0);
+		return 1;
+	}
+
+	std::string error = {};
+	const size_t called = bus->Dispatch(L, it->second, lua_gettop(L) - 1, error);
+	if (!error.empty()) {
+		return luaL_error(L, "%s", error.c_str());
+	}
+
+	lua_pushinteger(L, static_cast< lua_Integer >(called));
+	return 1;
+}
+
+} // namespace Script
@@ -0,0 +1,120 @@
+#ifndef FRAMEWORK_SCRIPT_EVENTBUS_HPP
+#define FRAMEWORK_SCRIPT_EVENTBUS_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Framework/Script/Reference.hpp>
+
+namespace Script
+{
+
+class Engine;
+
+// Handlers of every event live in one dense Lua array, ordered by priority (higher first) and
+// then by registration. Emit pushes its arguments once and calls the handlers in a loop.
+// Handlers added while the event is dispatched run from the next emit on, removed ones are
+// skipped immediately. A failing handler doesn't stop the others, errors go to the error
+// callback or, without one, the first is thrown once every handler ran.
+// Scripts use the global table EventBus: On(name, handler[, priority]), Once(...), Off(id), Emit(name, ...).
+class EventBus final
+{
+public:
+	using EventId = uint32_t;
+	using HandlerId = uint64_t;
+	using ErrorCallback = std::function< void(const std::string& event, const std::string& error) >;
+
+	explicit EventBus(const Engine*);
+	EventBus(const EventBus&) = delete;
+	EventBus(EventBus&&) = delete;
+	EventBus& operator=(const EventBus&) = delete;
+	EventBus& operator=(EventBus&&) = delete;
+	~EventBus() = default;
+
+	// Resolves a name once, emitting by id skips the lookup.
+	[[nodiscard]] auto GetEventId(const std::string& name) -> EventId;
+
+	auto On(EventId event, const Reference& handler, int32_t priority = 0, bool once = false) -> HandlerId;
+	auto On(const std::string& name, const Reference& handler, int32_t priority = 0, bool once = false) -> HandlerId;
+	auto Off(HandlerId handler) -> bool;
+
+	// Returns the number of handlers called.
+	template < typename... Args >
+	auto Emit(EventId event, const Args&... args) -> size_t;
+	template < typename... Args >
+	auto Emit(const std::string& name, const Args&... args) -> size_t;
+
+	[[nodiscard]] auto GetHandlerCount(EventId event) const -> size_t;
+
+	void SetErrorCallback(ErrorCallback callback);
+
+private:
+	struct Handler
+	{
+		HandlerId id = 0;
+		int32_t priority = 0;
+		bool once = false;
+		bool removed = false;
+	};
+
+	struct Event
+	{
+		std::string name = {};
+		std::vector< Handler > handlers = {};
+		uint32_t depth = 0;
+		bool dirty = false;
+	};
+
+	auto Add(lua_State*, EventId event, int32_t function, int32_t priority, bool once) -> HandlerId;
+	auto Remove(lua_State*, HandlerId handler) -> bool;
+	// Calls the handlers with the nargs values on top of the stack and pops them.
+	auto Dispatch(lua_State*, EventId event, int32_t nargs, std::string& error) -> size_t;
+	auto Dispatch(EventId event, int32_t nargs) -> size_t;
+	void PushHandlers(lua_State*, EventId event) const;
+	void Compact(lua_State*, EventId event);
+
+	static auto LuaOn(lua_State*) -> int32_t;
+	static auto LuaOnce(lua_State*) -> int32_t;
+	static auto LuaAdd(lua_State*, bool once) -> int32_t;
+	static auto LuaOff(lua_State*) -> int32_t;
+	static auto LuaEmit(lua_State*) -> int32_t;
+
+private:
+	lua_State* L = {};
+	Reference mTable = {};
+	std::vector< Event > mEvents = {};
+	std::unordered_map< std::string, EventId > mEventIds = {};
+	std::unordered_map< HandlerId, EventId > mHandlers = {};
+	HandlerId mNextHandler = 1;
+	ErrorCallback mErrorCallback = {};
+};
+
+using EventBusPtr = std::shared_ptr< EventBus >;
+
+template < typename... Args >
+auto EventBus::Emit(const EventId event, const Args&... args) -> size_t
+{
+	if (event >= mEvents.size() || mEvents[ event ].handlers.empty()) {
+		return 0;
+	}
+
+	Stack< void >::Push(L, args...);
+	return Dispatch(event, static_cast< int32_t >(sizeof...(Args)));
+}
+
+template < typename... Args >
+auto EventBus::Emit(const std::string& name, const Args&... args) -> size_t
+{
+	const auto it = mEventIds.find(name);
+	if (it == mEventIds.end()) {
+		return 0;
+	}
+	return Emit(it->second, args...);
+}
+
+} // namespace Script
+
+#endif
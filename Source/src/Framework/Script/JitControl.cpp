@@ -0,0 +1,239 @@
+#include <Framework/Script/JitControl.hpp>
+
+#include <Framework/Script/Engine.hpp>
+
+extern "C" {
+#include <luajit.h>
+#include <lualib.h>
+}
+
+#include <cstring>
+
+namespace Script
+{
+
+namespace
+{
+
+// Order of JitParameter, names as jit.opt.start expects them.
+constexpr const char* ParameterNames[] = {
+	"maxtrace",
+	"maxrecord",
+	"maxirconst",
+	"maxside",
+	"maxsnap",
+	"minstitch",
+	"hotloop",
+	"hotexit",
+	"tryside",
+	"instunroll",
+	"loopunroll",
+	"callunroll",
+	"recunroll",
+	"sizemcode",
+	"maxmcode",
+};
+
+// LJ_TRERR_MCODEAL, position of the entry in lj_traceerr.h.
+constexpr lua_Integer McodeAllocationError = 27;
+
+} // namespace
+
+JitControl::JitControl(const Engine* engine)
+	: L(engine->State())
+{
+	lua_getfield(L, LUA_REGISTRYINDEX, "_LOADED");
+	lua_getfield(L, -1, LUA_JITLIBNAME);
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+		lua_pushcfunction(L, luaopen_jit);
+		lua_pushstring(L, LUA_JITLIBNAME);
+		lua_call(L, 1, 0);
+		lua_getfield(L, -1, LUA_JITLIBNAME);
+
+		luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);
+		lua_pushnil(L);
+		lua_setglobal(L, LUA_JITLIBNAME);
+	}
+	mJit = Reference{ L, -1, true };
+	lua_pop(L, 1);
+
+	lua_getfield(L, LUA_REGISTRYINDEX, "_PRELOAD");
+	lua_getfield(L, -1, LUA_JITLIBNAME ".util");
+	lua_call(L, 0, 1);
+	mUtil = Reference{ L, -1, true };
+	lua_pop(L, 1);
+
+	lua_pushlightuserdata(L, this);
+	lua_pushcclosure(L, OnTrace, 1);
+	mCallback = Reference{ L, -1, true };
+
+	mJit.Push();
+	lua_getfield(L, -1, "attach");
+	mCallback.Push();
+	lua_pushstring(L, "trace");
+	lua_call(L, 2, 0);
+	lua_pop(L, 1);
+}
+
+JitControl::~JitControl()
+{
+	mJit.Push();
+	lua_getfield(L, -1, "attach");
+	mCallback.Push();
+	lua_call(L, 1, 0);
+	lua_pop(L, 1);
+}
+
+void JitControl::SetEnabled(const bool enabled) const
+{
+	luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | (enabled ? LUAJIT_MODE_ON : LUAJIT_MODE_OFF));
+}
+
+auto JitControl::IsEnabled() const -> bool
+{
+	mJit.Push();
+	lua_getfield(L, -1, "status");
+	lua_call(L, 0, 1);
+	const bool enabled = lua_toboolean(L, -1);
+	lua_pop(L, 2);
+	return enabled;
+}
+
+void JitControl::Flush() const
+{
+	luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_FLUSH);
+}
+
+void JitControl::SetParameter(const JitParameter parameter, const int32_t value) const
+{
+	if (value < 0) {
+		throw std::string{ "<Script::JitControl::SetParameter> Negative value" };
+	}
+	Start("<Script::JitControl::SetParameter>", std::string{ ParameterNames[ static_cast< size_t >(parameter) ] } + "=" + std::to_string(value));
+}
+
+void JitControl::SetOptimizationLevel(const int32_t level) const
+{
+	if (level < 0 || level > 3) {
+		throw std::string{ "<Script::JitControl::SetOptimizationLevel> Level must be between 0 and 3" };
+	}
+	Start("<Script::JitControl::SetOptimizationLevel>", std::to_string(level));
+}
+
+void JitControl::SetOptimization(const std::string& name, const bool enabled) const
+{
+	Start("<Script::JitControl::SetOptimization>", (enabled ? "+" : "-") + name);
+}
+
+void JitControl::SetFunctionMode(const Reference& function, const bool enabled, const bool recursive) const
+{
+	SetMode("<Script::JitControl::SetFunctionMode>", function,
+		(recursive ? LUAJIT_MODE_ALLFUNC : LUAJIT_MODE_FUNC) | (enabled ? LUAJIT_MODE_ON : LUAJIT_MODE_OFF));
+}
+
+void JitControl::FlushFunction(const Reference& function) const
+{
+	SetMode("<Script::JitControl::FlushFunction>", function, LUAJIT_MODE_FUNC | LUAJIT_MODE_FLUSH);
+}
+
+auto JitControl::GetStatistics() const -> JitStatistics
+{
+	return mStatistics;
+}
+
+void JitControl::ResetStatistics()
+{
+	mStatistics = JitStatistics{
+		.traces = mStatistics.traces,
+		.mcodeBytes = mStatistics.mcodeBytes,
+	};
+}
+
+auto JitControl::AddTraceHandler(TraceHandler handler) -> uint32_t
+{
+	const uint32_t id = mNextTraceHandler++;
+	mTraceHandlers.emplace(id, std::move(handler));
+	return id;
+}
+
+void JitControl::RemoveTraceHandler(const uint32_t handler)
+{
+	mTraceHandlers.erase(handler);
+}
+
+void JitControl::Start(const std::string& context, const std::string& option) const
+{
+	mJit.Push();
+	lua_getfield(L, -1, "opt");
+	lua_getfield(L, -1, "start");
+	lua_pushlstring(L, option.data(), option.size());
+
+	if (lua_pcall(L, 1, 0, 0)) {
+		const std::string error = lua_tostring(L, -1);
+		lua_pop(L, 3);
+		throw context + " " + error;
+	}
+	lua_pop(L, 2);
+}
+
+void JitControl::SetMode(const std::string& context, const Reference& function, const int32_t mode) const
+{
+	function.Push();
+	if (!lua_isfunction(L, -1) || lua_iscfunction(L, -1)) {
+		lua_pop(L, 1);
+		throw context + " Not a Lua function";
+	}
+
+	luaJIT_setmode(L, -1, mode);
+	lua_pop(L, 1);
+}
+
+// Trace events: ("start", tr, func, pc), ("stop", tr, func), ("abort", tr, func, pc, error, info), ("flush").
+auto JitControl::OnTrace(lua_State* L) -> int32_t
+{
+	JitControl* jit = static_cast< JitControl* >(lua_touserdata(L, lua_upvalueindex(1)));
+	JitStatistics& statistics = jit->mStatistics;
+
+	const char* what = lua_tostring(L, 1);
+	if (!what) {
+		return 0;
+	}
+
+	if (std::strcmp(what, "start") == 0) {
+		statistics.started++;
+
+	} else if (std::strcmp(what, "stop") == 0) {
+		statistics.compiled++;
+		statistics.traces++;
+
+		Utils::StrongRefGet(L, jit->mUtil.GetId());
+		lua_getfield(L, -1, "tracemc");
+		lua_remove(L, -2);
+		lua_pushvalue(L, 2);
+		if (lua_pcall(L, 1, 1, 0) == 0 && lua_isstring(L, -1)) {
+			statistics.mcodeBytes += lua_objlen(L, -1);
+		}
+		lua_pop(L, 1);
+
+	} else if (std::strcmp(what, "abort") == 0) {
+		statistics.aborted++;
+		if (lua_type(L, 5) == LUA_TNUMBER && lua_tointeger(L, 5) == McodeAllocationError) {
+			statistics.mcodeExhausted++;
+		}
+
+	} else if (std::strcmp(what, "flush") == 0) {
+		statistics.flushed++;
+		statistics.traces = 0;
+		statistics.mcodeBytes = 0;
+	}
+
+	const int32_t top = lua_gettop(L);
+	for (const auto& [ id, handler ] : jit->mTraceHandlers) {
+		handler(L);
+		lua_settop(L, top);
+	}
+	return 0;
+}
+
+} // namespace Script
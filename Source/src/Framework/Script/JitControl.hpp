@@ -0,0 +1,113 @@
+#ifndef FRAMEWORK_SCRIPT_JITCONTROL_HPP
+#define FRAMEWORK_SCRIPT_JITCONTROL_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <Framework/Script/Reference.hpp>
+
+namespace Script
+{
+
+class Engine;
+
+// Parameters of jit.opt.start, mcode sizes are in KBytes.
+enum class JitParameter : uint8_t {
+	MaxTrace,
+	MaxRecord,
+	MaxIrConst,
+	MaxSide,
+	MaxSnap,
+	MinStitch,
+	HotLoop,
+	HotExit,
+	TrySide,
+	InstUnroll,
+	LoopUnroll,
+	CallUnroll,
+	RecUnroll,
+	SizeMcode,
+	MaxMcode,
+};
+
+struct JitStatistics
+{
+	uint64_t started = 0;
+	uint64_t compiled = 0;
+	uint64_t aborted = 0;
+	uint64_t flushed = 0;
+	// Aborts because no more machine code could be allocated, all traces are flushed after each.
+	uint64_t mcodeExhausted = 0;
+	// Traces and machine code bytes alive since the last flush.
+	uint64_t traces = 0;
+	uint64_t mcodeBytes = 0;
+};
+
+// Typed access to the LuaJIT compiler of one engine. Trace events are counted from
+// the moment the facade exists. Without the jit library selected the library is opened
+// for the facade only, its global is not set and the compiler stays off until enabled.
+class JitControl final
+{
+public:
+	// Receives the arguments of a jit.attach trace event on the stack, must leave it balanced.
+	using TraceHandler = std::function< void(lua_State*) >;
+
+	explicit JitControl(const Engine*);
+	JitControl(const JitControl&) = delete;
+	JitControl(JitControl&&) = delete;
+	JitControl& operator=(const JitControl&) = delete;
+	JitControl& operator=(JitControl&&) = delete;
+	~JitControl();
+
+	void SetEnabled(bool enabled) const;
+	[[nodiscard]] auto IsEnabled() const -> bool;
+	void Flush() const;
+
+	void SetParameter(JitParameter parameter, int32_t value) const;
+	// Level 0 to 3, as jit.opt.start(level).
+	void SetOptimizationLevel(int32_t level) const;
+	// Single optimisation by name: fold, cse, dce, fwd, dse, narrow, loop, abc, sink, fuse, fma.
+	void SetOptimization(const std::string& name, bool enabled) const;
+
+	// recursive also changes the functions defined inside function.
+	void SetFunctionMode(const Reference& function, bool enabled, bool recursive = false) const;
+	void FlushFunction(const Reference& function) const;
+
+	[[nodiscard]] auto GetStatistics() const -> JitStatistics;
+	void ResetStatistics();
+
+	// LuaJIT keeps one handler per event, further listeners are chained here.
+	auto AddTraceHandler(TraceHandler handler) -> uint32_t;
+	void RemoveTraceHandler(uint32_t handler);
+	// The jit.util table.
+	[[nodiscard]] inline auto GetUtil() const -> const Reference&;
+
+private:
+	void Start(const std::string& context, const std::string& option) const;
+	void SetMode(const std::string& context, const Reference& function, int32_t mode) const;
+
+	static auto OnTrace(lua_State*) -> int32_t;
+
+private:
+	lua_State* L = {};
+	Reference mJit = {};
+	Reference mUtil = {};
+	Reference mCallback = {};
+	JitStatistics mStatistics = {};
+	std::map< uint32_t, TraceHandler > mTraceHandlers = {};
+	uint32_t mNextTraceHandler = 1;
+};
+
+using JitControlPtr = std::shared_ptr< JitControl >;
+
+auto JitControl::GetUtil() const -> const Reference&
+{
+	return mUtil;
+}
+
+} // namespace Script
+
+#endif
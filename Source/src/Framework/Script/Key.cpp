@@ -0,0 +1,56 @@
+#include <Framework/Script/Key.hpp>
+
+#include <atomic>
+
+namespace Script
+{
+
+namespace
+{
+
+// Registry key of the interned key strings: index -> string
+const char KeysKey = 0;
+
+} // namespace
+
+auto Keys::Register() -> int32_t
+{
+	static std::atomic< int32_t > counter = 0;
+	return ++counter;
+}
+
+void Keys::PushTable(lua_State* L)
+{
+	lua_pushlightuserdata(L, const_cast< char* >(&KeysKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	if (lua_istable(L, -1)) {
+		return;
+	}
+
+	lua_pop(L, 1);
+	lua_newtable(L);
+	lua_pushlightuserdata(L, const_cast< char* >(&KeysKey));
+	lua_pushvalue(L, -2);
+	lua_rawset(L, LUA_REGISTRYINDEX);
+}
+
+void Keys::Push(lua_State* L, int32_t tableIdx, const int32_t index, const std::string_view name)
+{
+	tableIdx = tableIdx < 0 ? lua_gettop(L) + tableIdx + 1 : tableIdx;
+
+	lua_rawgeti(L, tableIdx, index);
+	if (lua_type(L, -1) == LUA_TSTRING) {
+		size_t length = 0;
+		const char* cached = lua_tolstring(L, -1, &length);
+		if (std::string_view{ cached, length } == name) {
+			return;
+		}
+	}
+
+	lua_pop(L, 1);
+	lua_pushlstring(L, name.data(), name.size());
+	lua_pushvalue(L, -1);
+	lua_rawseti(L, tableIdx, index);
+}
+
+} // namespace Script
@@ -0,0 +1,70 @@
+#ifndef FRAMEWORK_SCRIPT_KEY_HPP
+#define FRAMEWORK_SCRIPT_KEY_HPP
+
+#include <Framework/Script/Stack/StackBasic.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Script
+{
+
+template < size_t Size >
+struct FixedString
+{
+	constexpr FixedString(const char (&string)[ Size ])
+	{
+		for (size_t i = 0; i < Size; ++i) {
+			data[ i ] = string[ i ];
+		}
+	}
+
+	[[nodiscard]] constexpr auto View() const -> std::string_view { return { data, Size - 1 }; }
+
+	char data[ Size ] = {};
+};
+
+// Per-engine table of interned key strings, indexed by a process-wide key id.
+class Keys final
+{
+public:
+	[[nodiscard]] static auto Register() -> int32_t;
+
+	static void PushTable(lua_State*);
+	// Pushes the interned string at index, (re)interning name when the slot holds anything else.
+	static void Push(lua_State*, int32_t tableIdx, int32_t index, std::string_view name);
+};
+
+// Constant table key, the Lua string is interned once per engine and fetched by index afterwards.
+template < FixedString Name >
+struct Key
+{
+	static constexpr std::string_view name = Name.View();
+
+	constexpr operator std::string_view() const { return name; }
+
+	// Registered on first use, so keys used by other static initializers get their id as well.
+	[[nodiscard]] static auto Index() -> int32_t
+	{
+		static const int32_t index = Keys::Register();
+		return index;
+	}
+
+	static void Push(lua_State* L)
+	{
+		Keys::PushTable(L);
+		Keys::Push(L, -1, Index(), name);
+		lua_remove(L, -2);
+	}
+};
+
+template < FixedString Name >
+struct Stack< Key< Name > >
+{
+	static void Push(lua_State* L, const Key< Name >&) { Key< Name >::Push(L); }
+};
+
+} // namespace Script
+
+#endif
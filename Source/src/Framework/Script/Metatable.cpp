@@ -3,15 +3,229 @@
 #include <Framework/Script/Engine.hpp>
 #include <Framework/Script/ObjectOwnership.hpp>
 
+#include <algorithm>
+#include <array>
+
 namespace Script
 {
 
+namespace
+{
+
+// Registry key of the inheritance bookkeeping: metatable -> { own = { field = true }, children = { metatable, ... }, sealed = bool }
+const char HierarchyKey = 0;
+
+// Fields bound to a single metatable, never inherited by descendants.
+constexpr std::array< std::string_view, 5 > PrivateFields = {
+	"__index",
+	"__newindex",
+	"__name",
+	"__gc",
+	"__properties",
+};
+
+auto IsPrivateField(lua_State* L, const int32_t idx) -> bool
+{
+	if (lua_type(L, idx) != LUA_TSTRING) {
+		return false;
+	}
+
+	size_t length = 0;
+	const char* field = lua_tolstring(L, idx, &length);
+	return std::find(PrivateFields.begin(), PrivateFields.end(), std::string_view{ field, length }) != PrivateFields.end();
+}
+
+auto AbsoluteIndex(lua_State* L, const int32_t idx) -> int32_t
+{
+	return idx < 0 && idx > LUA_REGISTRYINDEX ? lua_gettop(L) + idx + 1 : idx;
+}
+
+// Pushes the bookkeeping record of the metatable at idx, creating it on first use.
+void PushRecord(lua_State* L, int32_t idx)
+{
+	idx = AbsoluteIndex(L, idx);
+
+	lua_pushlightuserdata(L, const_cast< char* >(&HierarchyKey));
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+		lua_newtable(L);
+		lua_pushlightuserdata(L, const_cast< char* >(&HierarchyKey));
+		lua_pushvalue(L, -2);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+	}
+
+	lua_pushvalue(L, idx);
+	lua_rawget(L, -2);
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+		lua_createtable(L, 0, 3);
+
+		lua_newtable(L);
+		lua_setfield(L, -2, "own");
+		lua_newtable(L);
+		lua_setfield(L, -2, "children");
+		lua_pushboolean(L, false);
+		lua_setfield(L, -2, "sealed");
+
+		lua_pushvalue(L, idx);
+		lua_pushvalue(L, -2);
+		lua_rawset(L, -4);
+	}
+
+	lua_remove(L, -2);
+}
+
+// upvalues: properties, metatable
+auto PropertyIndex(lua_State* L) -> int32_t
+{
+	// Derived metatables reach here through their setmetatable chain, they only ever look up fields.
+	lua_pushvalue(L, 2);
+	lua_rawget(L, lua_upvalueindex(1));
+	if (lua_type(L, -1) == LUA_TUSERDATA && !lua_istable(L, 1)) {
+		const auto* property = static_cast< const Metatable::Property* >(lua_touserdata(L, -1));
+		lua_pop(L, 1);
+		return property->get(L, property);
+	}
+
+	lua_pop(L, 1);
+	lua_pushvalue(L, 2);
+	lua_gettable(L, lua_upvalueindex(2));
+	return 1;
+}
+
+// upvalues: properties, metatable
+auto PropertyNewIndex(lua_State* L) -> int32_t
+{
+	if (lua_istable(L, 1)) {
+		lua_rawset(L, 1);
+		return 0;
+	}
+
+	lua_pushvalue(L, 2);
+	lua_rawget(L, lua_upvalueindex(1));
+	if (lua_type(L, -1) == LUA_TUSERDATA) {
+		const auto* property = static_cast< const Metatable::Property* >(lua_touserdata(L, -1));
+		lua_pop(L, 1);
+		if (property->set) {
+			return property->set(L, property);
+		}
+	}
+
+	lua_getfield(L, lua_upvalueindex(2), "__name");
+	return luaL_error(L, "<Script::Metatable::Property> '%s.%s' is not a writable property", lua_tostring(L, -1), lua_tostring(L, 2));
+}
+
+// Pushes the properties table of the metatable at idx, installing the property handlers on first use.
+void PushProperties(lua_State* L, int32_t idx)
+{
+	idx = AbsoluteIndex(L, idx);
+
+	lua_getfield(L, idx, "__properties");
+	if (lua_istable(L, -1)) {
+		return;
+	}
+
+	lua_pop(L, 1);
+	lua_newtable(L);
+
+	lua_pushvalue(L, -1);
+	lua_setfield(L, idx, "__properties");
+
+	lua_pushvalue(L, -1);
+	lua_pushvalue(L, idx);
+	lua_pushcclosure(L, PropertyIndex, 2);
+	lua_setfield(L, idx, "__index");
+
+	lua_pushvalue(L, -1);
+	lua_pushvalue(L, idx);
+	lua_pushcclosure(L, PropertyNewIndex, 2);
+	lua_setfield(L, idx, "__newindex");
+}
+
+// Pops the value at the top of the stack into the field or property of the metatable at idx.
+void AssignField(lua_State* L, int32_t idx, const std::string& name, const bool property)
+{
+	idx = AbsoluteIndex(L, idx);
+
+	if (property) {
+		PushProperties(L, idx);
+		lua_pushlstring(L, name.data(), name.size());
+		lua_pushvalue(L, -3);
+		lua_rawset(L, -3);
+		lua_pop(L, 2);
+	} else {
+		lua_pushlstring(L, name.data(), name.size());
+		lua_insert(L, -2);
+		lua_rawset(L, idx);
+	}
+}
+
+// Copies the value at the top of the stack into every descendant of the metatable at idx which does not define the field itself.
+// Sealed descendants are final, the propagation stops there.
+void PropagateField(lua_State* L, const int32_t idx, const std::string& name, const bool property)
+{
+	PushRecord(L, idx);
+	lua_getfield(L, -1, "children");
+
+	const size_t children = lua_objlen(L, -1);
+	for (size_t i = 1; i <= children; ++i) {
+		lua_rawgeti(L, -1, static_cast< int32_t >(i));
+
+		PushRecord(L, -1);
+		lua_getfield(L, -1, "sealed");
+		const bool sealed = lua_toboolean(L, -1);
+		lua_getfield(L, -2, "own");
+		lua_getfield(L, -1, name.c_str());
+		const bool overridden = lua_toboolean(L, -1);
+		lua_pop(L, 4);
+
+		if (!sealed && !overridden) {
+			lua_pushvalue(L, -4);
+			AssignField(L, -2, name, property);
+
+			lua_pushvalue(L, -4);
+			PropagateField(L, -2, name, property);
+			lua_pop(L, 1);
+		}
+
+		lua_pop(L, 1);
+	}
+
+	lua_pop(L, 2);
+}
+
+void SealMetatable(lua_State* L, const int32_t idx)
+{
+	PushRecord(L, idx);
+
+	lua_pushboolean(L, true);
+	lua_setfield(L, -2, "sealed");
+
+	lua_pushnil(L);
+	lua_setmetatable(L, idx);
+
+	lua_getfield(L, -1, "children");
+	const size_t children = lua_objlen(L, -1);
+	for (size_t i = 1; i <= children; ++i) {
+		lua_rawgeti(L, -1, static_cast< int32_t >(i));
+		SealMetatable(L, lua_gettop(L));
+		lua_pop(L, 1);
+	}
+
+	lua_pop(L, 2);
+}
+
+} // namespace
+
 Metatable::Metatable(const Engine* engine, std::string_view metatable)
 	: Metatable(engine, metatable, std::string{})
 {
 }
 
 Metatable::Metatable(const Engine* engine, std::string_view metatable, std::string_view parent)
+	: mName(metatable)
+	, mState(engine->State())
 {
 	mReference = engine->GetGlobal(metatable.data());
 	if (mReference.GetType() != Script::VariableType::Nil) {
@@ -21,38 +235,63 @@ Metatable::Metatable(const Engine* engine, std::string_view metatable, std::stri
 	lua_State* L = engine->State();
 
 	luaL_newmetatable(L, metatable.data());
-	lua_pushvalue(L, -1);
+	const int32_t metatableIdx = lua_gettop(L);
 
+	lua_pushvalue(L, -1);
 	lua_setfield(L, -2, "__index");
 
+	lua_pushlstring(L, metatable.data(), metatable.size());
+	lua_setfield(L, -2, "__name");
+
+	PushRecord(L, metatableIdx);
+	lua_pop(L, 1);
+
 	if (!parent.empty()) {
 		luaL_getmetatable(L, parent.data());
 
-		lua_pushvalue(L, -1);
-		lua_setmetatable(L, -3);
-
-		{
-			const std::vector< std::string_view > OverloadOperators = {
-				"__eq",
-				"__add",
-				"__sub",
-				"__mul",
-				"__div",
-				"__mod",
-				"__pow",
-				"__unm",
-				"__len",
-				"__lt",
-				"__le",
-				"__concat",
-				"__call",
-				"__tostring",
-			};
-
-			for (const std::string_view& copyOperator : OverloadOperators) {
-				lua_getfield(L, -2, copyOperator.data());
-				lua_setfield(L, -3, copyOperator.data());
+		if (lua_istable(L, -1)) {
+			const int32_t parentIdx = lua_gettop(L);
+
+			// Flatten every inherited field, so lookups never walk the parent chain.
+			lua_pushnil(L);
+			while (lua_next(L, parentIdx)) {
+				if (!IsPrivateField(L, -2)) {
+					lua_pushvalue(L, -2);
+					lua_insert(L, -2);
+					lua_rawset(L, metatableIdx);
+				} else {
+					lua_pop(L, 1);
+				}
+			}
+
+			lua_getfield(L, parentIdx, "__properties");
+			if (lua_istable(L, -1)) {
+				PushProperties(L, metatableIdx);
+				lua_pushnil(L);
+				while (lua_next(L, -3)) {
+					lua_pushvalue(L, -2);
+					lua_insert(L, -2);
+					lua_rawset(L, -4);
+				}
+				lua_pop(L, 1);
+			}
+			lua_pop(L, 1);
+
+			Utils::SetParentMetatable(L, metatableIdx, parentIdx);
+			PushRecord(L, parentIdx);
+
+			// Until the parent is sealed, fields assigned to it directly from scripts are still reachable through the chain.
+			lua_getfield(L, -1, "sealed");
+			if (!lua_toboolean(L, -1)) {
+				lua_pushvalue(L, parentIdx);
+				lua_setmetatable(L, metatableIdx);
 			}
+			lua_pop(L, 1);
+
+			lua_getfield(L, -1, "children");
+			lua_pushvalue(L, metatableIdx);
+			lua_rawseti(L, -2, static_cast< int32_t >(lua_objlen(L, -2) + 1));
+			lua_pop(L, 2);
 		}
 
 		lua_pop(L, 1);
@@ -68,9 +307,11 @@ auto Metatable::RegisterReferenceDestructor(const Engine*) -> Metatable*
 		const VariableType type = static_cast< VariableType >(lua_type(L, -1));
 
 		if (type == VariableType::UserData) {
-			ObjectOwnership** pointer = static_cast< ObjectOwnership** >(lua_touserdata(L, -1));
-			delete *pointer;
-			*pointer = nullptr;
+			if (ObjectHeader* header = ObjectHeader::Get(L, -1)) {
+				Utils::CountObject(L, -1, -1);
+				delete header->ownership;
+				header->ownership = nullptr;
+			}
 
 		} else if (type == VariableType::LightUserData) {
 			throw std::string{ "<Script::Metatable::RegisterReferenceDestructor> Invalid collector type: 'LightUserData'" };
@@ -79,8 +320,66 @@ auto Metatable::RegisterReferenceDestructor(const Engine*) -> Metatable*
 		return 0;
 	});
 
-	mReference.SetField("__gc", GarbageCollector);
+	return SetField("__gc", GarbageCollector);
+}
+
+auto Metatable::Seal() -> Metatable*
+{
+	lua_State* L = mState;
+	mReference.Push();
+	SealMetatable(L, lua_gettop(L));
+	lua_pop(L, 1);
 	return this;
 }
 
+auto Metatable::IsSealed() const -> bool
+{
+	lua_State* L = mState;
+	mReference.Push();
+	PushRecord(L, -1);
+	lua_getfield(L, -1, "sealed");
+	const bool sealed = lua_toboolean(L, -1);
+	lua_pop(L, 3);
+	return sealed;
+}
+
+void Metatable::Propagate(const std::string& name) const
+{
+	lua_State* L = mState;
+	mReference.Push();
+
+	PushRecord(L, -1);
+	lua_getfield(L, -1, "own");
+	lua_pushboolean(L, true);
+	lua_setfield(L, -2, name.c_str());
+	lua_pop(L, 2);
+
+	lua_pushlstring(L, name.data(), name.size());
+	if (!IsPrivateField(L, -1)) {
+		lua_rawget(L, -2);
+		PropagateField(L, -2, name, false);
+	}
+
+	lua_pop(L, 2);
+}
+
+void Metatable::RegisterProperty(const std::string& name) const
+{
+	lua_State* L = mState;
+	mReference.Push();
+
+	PushRecord(L, -1);
+	lua_getfield(L, -1, "own");
+	lua_pushboolean(L, true);
+	lua_setfield(L, -2, name.c_str());
+	lua_pop(L, 2);
+
+	lua_pushvalue(L, -2);
+	AssignField(L, -2, name, true);
+
+	lua_insert(L, -2);
+	PropagateField(L, -2, name, true);
+	lua_pop(L, 2);
+}
+
 } // namespace Script
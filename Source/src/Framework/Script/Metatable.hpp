@@ -2,9 +2,12 @@
 #define FRAMEWORK_SCRIPT_METATABLE_HPP
 
 #include <memory>
+#include <new>
 #include <string_view>
 
+#include <Framework/Script/Key.hpp>
 #include <Framework/Script/Reference.hpp>
+#include <Framework/Script/Stack/Stack.hpp>
 
 namespace Script
 {
@@ -15,24 +18,156 @@ class Metatable final
 {
 public:
 	explicit Metatable(const Engine*, std::string_view metatable);
+	// Every field of the parent is copied into the metatable and later SetField calls on an ancestor
+	// reach it unless it defines the field itself. The setmetatable chain stays until Seal() for fields
+	// assigned from scripts, so lookups give the same results as through the chain alone.
 	explicit Metatable(const Engine*, std::string_view metatable, std::string_view parent);
 
 	auto RegisterReferenceDestructor(const Engine*) -> Metatable*;
 
 	template < typename Function >
 	auto SetField(const std::string& name, Function function) -> Metatable*;
+	template < FixedString Name, typename Function >
+	auto SetField(Key< Name > key, Function function) -> Metatable*;
+
+	// Properties are served by a single C __index/__newindex pair, without calling a bound function per access.
+	template < class Class, typename Type >
+	auto SetProperty(const std::string& name, Type Class::*member) -> Metatable*;
+
+	template < class Class, typename Return, typename Value = Return >
+	auto SetProperty(const std::string& name, Return (Class::*getter)() const, void (Class::*setter)(Value) = nullptr) -> Metatable*;
+
+	// Finalizes registration of this metatable and its descendants, further SetField calls throw
+	// and fields set on ancestors no longer reach them.
+	auto Seal() -> Metatable*;
+	[[nodiscard]] auto IsSealed() const -> bool;
+
+	struct Property
+	{
+		using Accessor = int32_t (*)(lua_State*, const Property*);
+
+		Accessor get = nullptr;
+		Accessor set = nullptr;
+	};
+
+private:
+	template < typename Data >
+	struct PropertyData : Property
+	{
+		Data data;
+	};
+
+	template < typename Data >
+	void PushProperty(Property::Accessor get, Property::Accessor set, Data data) const;
+
+	template < class Class >
+	static auto GetObject(lua_State*) -> Class*;
+
+	void Propagate(const std::string& name) const;
+	void RegisterProperty(const std::string& name) const;
 
 private:
+	std::string mName = {};
+	lua_State* mState = {};
 	Reference mReference = {};
 };
 
 template < typename Function >
 auto Metatable::SetField(const std::string& name, Function function) -> Metatable*
 {
+	if (IsSealed()) {
+		throw std::string{ "<Script::Metatable::SetField> Metatable '" } + mName + "' is sealed";
+	}
+
 	mReference.SetField(name, function);
+	Propagate(name);
+	return this;
+}
+
+template < FixedString Name, typename Function >
+auto Metatable::SetField(const Key< Name > key, Function function) -> Metatable*
+{
+	if (IsSealed()) {
+		throw std::string{ "<Script::Metatable::SetField> Metatable '" } + mName + "' is sealed";
+	}
+
+	mReference.SetField(key, function);
+	Propagate(std::string{ key.name });
 	return this;
 }
 
+template < class Class, typename Type >
+auto Metatable::SetProperty(const std::string& name, Type Class::*member) -> Metatable*
+{
+	using Data = PropertyData< Type Class::* >;
+
+	const auto get = [](lua_State* L, const Property* property) -> int32_t {
+		Stack< std::remove_const_t< Type > >::Push(L, GetObject< Class >(L)->*static_cast< const Data* >(property)->data);
+		return 1;
+	};
+
+	const auto set = [](lua_State* L, const Property* property) -> int32_t {
+		if constexpr (!std::is_const_v< Type >) {
+			GetObject< Class >(L)->*static_cast< const Data* >(property)->data = Stack< Type >::Get(L, 3);
+		}
+		return 0;
+	};
+
+	PushProperty(get, std::is_const_v< Type > ? nullptr : +set, member);
+	RegisterProperty(name);
+	return this;
+}
+
+template < class Class, typename Return, typename Value >
+auto Metatable::SetProperty(const std::string& name, Return (Class::*getter)() const, void (Class::*setter)(Value)) -> Metatable*
+{
+	struct Accessors
+	{
+		Return (Class::*getter)() const;
+		void (Class::*setter)(Value);
+	};
+
+	using Data = PropertyData< Accessors >;
+	using ValueType = typename TypeTraits::RemoveConstReference< Value >::Type;
+
+	const auto get = [](lua_State* L, const Property* property) -> int32_t {
+		Stack< typename TypeTraits::RemoveConstReference< Return >::Type >::Push(L, (GetObject< Class >(L)->*static_cast< const Data* >(property)->data.getter)());
+		return 1;
+	};
+
+	const auto set = [](lua_State* L, const Property* property) -> int32_t {
+		(GetObject< Class >(L)->*static_cast< const Data* >(property)->data.setter)(Stack< ValueType >::Get(L, 3));
+		return 0;
+	};
+
+	PushProperty(get, setter ? +set : nullptr, Accessors{ getter, setter });
+	RegisterProperty(name);
+	return this;
+}
+
+template < typename Data >
+void Metatable::PushProperty(Property::Accessor get, Property::Accessor set, Data data) const
+{
+	if (IsSealed()) {
+		throw std::string{ "<Script::Metatable::SetProperty> Metatable '" } + mName + "' is sealed";
+	}
+
+	static_assert(std::is_trivially_destructible_v< Data >, "Property data is stored in userdata without a collector");
+
+	void* userdata = lua_newuserdata(mState, sizeof(PropertyData< Data >));
+	new (userdata) PropertyData< Data >{ { get, set }, data };
+}
+
+template < class Class >
+auto Metatable::GetObject(lua_State* L) -> Class*
+{
+	Class* object = Stack< Class* >::Get(L, 1);
+	if (!object) {
+		luaL_error(L, "<Script::Metatable::Property> Invalid object");
+	}
+	return object;
+}
+
 using MetatablePtr = std::shared_ptr< Metatable >;
 
 } // namespace Script
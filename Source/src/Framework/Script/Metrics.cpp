@@ -0,0 +1,184 @@
+#include <Framework/Script/Metrics.hpp>
+
+#include <cstdio>
+
+namespace Script
+{
+
+namespace
+{
+
+template < typename Source >
+struct Series
+{
+	// Field name in JSON, metric name without prefix in Prometheus.
+	const char* key = nullptr;
+	const char* name = nullptr;
+	const char* help = nullptr;
+	const char* type = nullptr;
+	uint64_t (*get)(const Source&) = nullptr;
+};
+
+constexpr Series< EngineMetrics > EngineSeries[] = {
+	{ "heapBytes", "heap_bytes", "Lua heap size in bytes.", "gauge", [](const EngineMetrics& metrics) { return metrics.heapBytes; } },
+	{ "strongReferences", "strong_references", "Registry references in use.", "gauge", [](const EngineMetrics& metrics) { return metrics.strongReferences; } },
+	{ "weakReferences", "weak_references", "Weak references in use.", "gauge", [](const EngineMetrics& metrics) { return metrics.weakReferences; } },
+	{ "boundFunctions", "bound_functions", "Live bound C++ functions.", "gauge", [](const EngineMetrics& metrics) { return metrics.boundFunctions; } },
+	{ "protectedCalls", "protected_calls_total", "Protected calls into Lua.", "counter", [](const EngineMetrics& metrics) { return metrics.protectedCalls; } },
+	{ "errors", "errors_total", "Protected calls into Lua that failed.", "counter", [](const EngineMetrics& metrics) { return metrics.errors; } },
+	{ "gcCycles", "gc_cycles_total", "Completed garbage collection cycles.", "counter", [](const EngineMetrics& metrics) { return metrics.gcCycles; } },
+};
+
+constexpr Series< JitStatistics > JitSeries[] = {
+	{ "started", "jit_traces_started_total", "Traces started.", "counter", [](const JitStatistics& jit) { return jit.started; } },
+	{ "compiled", "jit_traces_compiled_total", "Traces compiled.", "counter", [](const JitStatistics& jit) { return jit.compiled; } },
+	{ "aborted", "jit_traces_aborted_total", "Traces aborted.", "counter", [](const JitStatistics& jit) { return jit.aborted; } },
+	{ "flushed", "jit_flushes_total", "Trace cache flushes.", "counter", [](const JitStatistics& jit) { return jit.flushed; } },
+	{ "mcodeExhausted", "jit_mcode_exhausted_total", "Aborts for lack of machine code memory.", "counter", [](const JitStatistics& jit) { return jit.mcodeExhausted; } },
+	{ "traces", "jit_traces", "Traces alive.", "gauge", [](const JitStatistics& jit) { return jit.traces; } },
+	{ "mcodeBytes", "jit_mcode_bytes", "Machine code bytes of the traces alive.", "gauge", [](const JitStatistics& jit) { return jit.mcodeBytes; } },
+};
+
+void AppendJsonString(std::string& out, const std::string& value)
+{
+	out.push_back('"');
+	for (const char character : value) {
+		switch (character) {
+			case '"':
+				out.append("\\\"");
+				break;
+			case '\\':
+				out.append("\\\\");
+				break;
+			case '\n':
+				out.append("\\n");
+				break;
+			default:
+				if (static_cast< unsigned char >(character) < 0x20) {
+					char escaped[ 7 ] = {};
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast< unsigned char >(character));
+					out.append(escaped);
+				} else {
+					out.push_back(character);
+				}
+		}
+	}
+	out.push_back('"');
+}
+
+void AppendLabelValue(std::string& out, const std::string& value)
+{
+	out.push_back('"');
+	for (const char character : value) {
+		switch (character) {
+			case '"':
+				out.append("\\\"");
+				break;
+			case '\\':
+				out.append("\\\\");
+				break;
+			case '\n':
+				out.append("\\n");
+				break;
+			default:
+				out.push_back(character);
+		}
+	}
+	out.push_back('"');
+}
+
+template < typename Source, size_t Size >
+void AppendJsonFields(std::string& out, const Source& source, const Series< Source > (&series)[ Size ])
+{
+	for (const auto& entry : series) {
+		if (out.back() != '{') {
+			out.push_back(',');
+		}
+		AppendJsonString(out, entry.key);
+		out.push_back(':');
+		out.append(std::to_string(entry.get(source)));
+	}
+}
+
+void AppendHeader(std::string& out, const std::string& prefix, const char* name, const char* help, const char* type)
+{
+	out.append("# HELP ").append(prefix).append("_").append(name).append(" ").append(help).append("\n");
+	out.append("# TYPE ").append(prefix).append("_").append(name).append(" ").append(type).append("\n");
+}
+
+void AppendSample(std::string& out, const std::string& prefix, const char* name, const std::string& engine, const uint64_t value)
+{
+	out.append(prefix).append("_").append(name).append("{engine=");
+	AppendLabelValue(out, engine);
+	out.append("} ").append(std::to_string(value)).append("\n");
+}
+
+} // namespace
+
+auto MetricsExporter::ToJson(const Pool& pool) -> std::string
+{
+	std::string out = "{\"engines\":[";
+	for (const auto& [ engine, metrics ] : pool) {
+		if (out.back() != '[') {
+			out.push_back(',');
+		}
+
+		out.append("{\"name\":");
+		AppendJsonString(out, engine);
+		AppendJsonFields(out, metrics, EngineSeries);
+
+		out.append(",\"objects\":{");
+		for (const auto& [ metatable, count ] : metrics.objects) {
+			if (out.back() != '{') {
+				out.push_back(',');
+			}
+			AppendJsonString(out, metatable);
+			out.push_back(':');
+			out.append(std::to_string(count));
+		}
+		out.push_back('}');
+
+		if (metrics.jit) {
+			out.append(",\"jit\":{");
+			AppendJsonFields(out, *metrics.jit, JitSeries);
+			out.push_back('}');
+		}
+		out.push_back('}');
+	}
+	out.append("]}");
+	return out;
+}
+
+auto MetricsExporter::ToPrometheus(const Pool& pool, const std::string& prefix) -> std::string
+{
+	std::string out = {};
+	for (const auto& series : EngineSeries) {
+		AppendHeader(out, prefix, series.name, series.help, series.type);
+		for (const auto& [ engine, metrics ] : pool) {
+			AppendSample(out, prefix, series.name, engine, series.get(metrics));
+		}
+	}
+
+	AppendHeader(out, prefix, "objects", "Live object userdata by metatable.", "gauge");
+	for (const auto& [ engine, metrics ] : pool) {
+		for (const auto& [ metatable, count ] : metrics.objects) {
+			out.append(prefix).append("_objects{engine=");
+			AppendLabelValue(out, engine);
+			out.append(",metatable=");
+			AppendLabelValue(out, metatable);
+			out.append("} ").append(std::to_string(count)).append("\n");
+		}
+	}
+
+	for (const auto& series : JitSeries) {
+		AppendHeader(out, prefix, series.name, series.help, series.type);
+		for (const auto& [ engine, metrics ] : pool) {
+			if (metrics.jit) {
+				AppendSample(out, prefix, series.name, engine, series.get(*metrics.jit));
+			}
+		}
+	}
+	return out;
+}
+
+} // namespace Script
@@ -0,0 +1,50 @@
+#ifndef FRAMEWORK_SCRIPT_METRICS_HPP
+#define FRAMEWORK_SCRIPT_METRICS_HPP
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Framework/Script/JitControl.hpp>
+
+namespace Script
+{
+
+struct EngineMetrics
+{
+	// LUA_GCCOUNT and LUA_GCCOUNTB.
+	uint64_t heapBytes = 0;
+	// Registry references of Utils::StrongRefSet and weak references in __ref still in use.
+	uint64_t strongReferences = 0;
+	uint64_t weakReferences = 0;
+	// Live object userdata by metatable name. Objects of metatables without a reference
+	// destructor stay counted, their ownership is never released either.
+	std::map< std::string, uint64_t > objects = {};
+	// Live userdata of bound C++ functions.
+	uint64_t boundFunctions = 0;
+	// Protected calls made by the library into Lua and how many of them failed.
+	uint64_t protectedCalls = 0;
+	uint64_t errors = 0;
+	// Completed garbage collection cycles.
+	uint64_t gcCycles = 0;
+	// Only once Engine::Jit() was used.
+	std::optional< JitStatistics > jit = {};
+};
+
+// Renders the metrics of a pool of engines, each given with the name it is labelled with.
+class MetricsExporter final
+{
+public:
+	using Pool = std::vector< std::pair< std::string, EngineMetrics > >;
+
+	[[nodiscard]] static auto ToJson(const Pool& pool) -> std::string;
+	// Prometheus text exposition format, every series carries an engine label.
+	[[nodiscard]] static auto ToPrometheus(const Pool& pool, const std::string& prefix = "script") -> std::string;
+};
+
+} // namespace Script
+
+#endif
@@ -1,34 +1,60 @@
 #ifndef FRAMEWORK_SCRIPT_OBJECTOWNERSHIP_HPP
 #define FRAMEWORK_SCRIPT_OBJECTOWNERSHIP_HPP
 
+#include <Framework/Script/Basic.hpp>
+#include <Framework/Script/TypeRegistry.hpp>
+
 #include <memory>
 
 namespace Script
 {
 
-using ObjectPtr = std::shared_ptr< class Object >;
-
 class ObjectOwnership final
 {
 public:
-	inline explicit ObjectOwnership(ObjectPtr object);
+	inline explicit ObjectOwnership(std::shared_ptr< void > object);
 
-	[[nodiscard]] inline auto Get() const -> ObjectPtr;
+	[[nodiscard]] inline auto Get() const -> const std::shared_ptr< void >&;
 
 private:
-	const ObjectPtr mObject = {};
+	const std::shared_ptr< void > mObject = {};
 };
 
-ObjectOwnership::ObjectOwnership(ObjectPtr object)
+// Layout of every object userdata, the type id makes type checks an integer compare.
+struct ObjectHeader
+{
+	// Tells object userdata apart from other userdata of the same size.
+	static constexpr uint64_t Magic = 0x4f424a4543544844;
+
+	uint64_t magic = Magic;
+	ObjectOwnership* ownership = nullptr;
+	TypeId type = nullptr;
+	void* pointer = nullptr;
+
+	// Returns nullptr for other userdata or already collected objects.
+	[[nodiscard]] inline static auto Get(lua_State*, const int32_t idx) -> ObjectHeader*;
+};
+
+ObjectOwnership::ObjectOwnership(std::shared_ptr< void > object)
 	: mObject(std::move(object))
 {
 }
 
-auto ObjectOwnership::Get() const -> ObjectPtr
+auto ObjectOwnership::Get() const -> const std::shared_ptr< void >&
 {
 	return mObject;
 }
 
+auto ObjectHeader::Get(lua_State* L, const int32_t idx) -> ObjectHeader*
+{
+	if (lua_type(L, idx) != LUA_TUSERDATA || lua_objlen(L, idx) != sizeof(ObjectHeader)) {
+		return nullptr;
+	}
+
+	ObjectHeader* header = static_cast< ObjectHeader* >(lua_touserdata(L, idx));
+	return header->magic == Magic && header->ownership ? header : nullptr;
+}
+
 } // namespace Script
 
 #endif
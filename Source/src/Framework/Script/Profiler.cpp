@@ -0,0 +1,121 @@
+#include <Framework/Script/Profiler.hpp>
+
+extern "C" {
+#include <luajit.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <string_view>
+
+namespace Script
+{
+
+namespace
+{
+
+constexpr int32_t StackDepth = 64;
+
+std::atomic< const Profiler* > ActiveProfiler = nullptr;
+
+auto VmStateFrame(const int vmstate) -> std::string_view
+{
+	switch (vmstate) {
+		case 'N': return "[compiled]";
+		case 'I': return "[interpreted]";
+		case 'C': return "[native]";
+		case 'G': return "[gc]";
+		case 'J': return "[compiler]";
+		default: return "[unknown]";
+	}
+}
+
+} // namespace
+
+auto Profile::GetSamples() const -> uint64_t
+{
+	return interpreted + compiled + native + garbageCollector + compiler;
+}
+
+auto Profile::ToFolded() const -> std::string
+{
+	std::string folded = {};
+	for (const auto& [ stack, samples ] : stacks) {
+		folded.append(stack);
+		folded.push_back(' ');
+		folded.append(std::to_string(samples));
+		folded.push_back('\n');
+	}
+	return folded;
+}
+
+Profiler::Profiler(lua_State* L)
+	: L(L)
+{
+}
+
+Profiler::~Profiler()
+{
+	if (mRunning) {
+		static_cast< void >(Stop());
+	}
+}
+
+void Profiler::Start(const std::chrono::milliseconds interval)
+{
+	if (mRunning) {
+		return;
+	}
+
+	const Profiler* expected = nullptr;
+	if (!ActiveProfiler.compare_exchange_strong(expected, this)) {
+		throw std::string{ "<Script::Profiler::Start> Profiler is already running for another engine" };
+	}
+
+	const std::string mode = "fi" + std::to_string(std::max(interval.count(), std::chrono::milliseconds::rep{ 1 }));
+	mProfile = {};
+	mRunning = true;
+	luaJIT_profile_start(L, mode.c_str(), Sample, this);
+}
+
+auto Profiler::Stop() -> Profile
+{
+	if (!mRunning) {
+		return {};
+	}
+
+	luaJIT_profile_stop(L);
+	mRunning = false;
+	ActiveProfiler = nullptr;
+	return std::move(mProfile);
+}
+
+void Profiler::Sample(void* data, lua_State* L, const int samples, const int vmstate)
+{
+	Profile& profile = static_cast< Profiler* >(data)->mProfile;
+	const uint64_t count = static_cast< uint64_t >(samples);
+
+	switch (vmstate) {
+		case 'N': profile.compiled += count; break;
+		case 'I': profile.interpreted += count; break;
+		case 'C': profile.native += count; break;
+		case 'G': profile.garbageCollector += count; break;
+		case 'J': profile.compiler += count; break;
+		default: break;
+	}
+
+	size_t length = 0;
+	const char* dump = luaJIT_profile_dumpstack(L, "FZ\x01", -StackDepth, &length);
+
+	std::string stack{ dump, length };
+	std::replace(stack.begin(), stack.end(), ';', ':');
+	std::replace(stack.begin(), stack.end(), '\x01', ';');
+	if (!stack.empty()) {
+		stack.push_back(';');
+	}
+	stack.append(VmStateFrame(vmstate));
+
+	profile.stacks[ stack ] += count;
+}
+
+} // namespace Script
@@ -0,0 +1,60 @@
+#ifndef FRAMEWORK_SCRIPT_PROFILER_HPP
+#define FRAMEWORK_SCRIPT_PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+struct lua_State;
+
+namespace Script
+{
+
+struct Profile
+{
+	uint64_t interpreted = 0;
+	uint64_t compiled = 0;
+	uint64_t native = 0;
+	uint64_t garbageCollector = 0;
+	uint64_t compiler = 0;
+	std::unordered_map< std::string, uint64_t > stacks = {};
+
+	[[nodiscard]] auto GetSamples() const -> uint64_t;
+	[[nodiscard]] auto ToFolded() const -> std::string;
+};
+
+// Wraps the LuaJIT sampling profiler. LuaJIT keeps a single profiler per
+// process, so only one Engine can be profiled at a time.
+class Profiler final
+{
+public:
+	explicit Profiler(lua_State*);
+	Profiler(const Profiler&) = delete;
+	Profiler(Profiler&&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+	Profiler& operator=(Profiler&&) = delete;
+	~Profiler();
+
+	void Start(std::chrono::milliseconds interval);
+	auto Stop() -> Profile;
+
+	[[nodiscard]] inline auto IsRunning() const -> bool;
+
+private:
+	static void Sample(void* data, lua_State* L, int samples, int vmstate);
+
+private:
+	lua_State* L = {};
+	bool mRunning = false;
+	Profile mProfile = {};
+};
+
+auto Profiler::IsRunning() const -> bool
+{
+	return mRunning;
+}
+
+} // namespace Script
+
+#endif
@@ -84,6 +84,28 @@ auto Reference::CallSandbox(const std::string& script) const -> bool
 	return true;
 }
 
+void Reference::PushCallable(const char* context) const
+{
+	lua_State* L = mPointer->L;
+
+	Push();
+	if (lua_isfunction(L, -1)) {
+		return;
+	}
+
+	if (lua_getmetatable(L, -1)) {
+		lua_getfield(L, -1, "__call");
+		const bool callable = lua_isfunction(L, -1);
+		lua_pop(L, 2);
+		if (callable) {
+			return;
+		}
+	}
+
+	lua_pop(L, 1);
+	throw std::string{ context } + " is not callable";
+}
+
 void Reference::Push() const
 {
 	Utils::StrongRefGet(mPointer->L, mPointer->id);
@@ -2,14 +2,44 @@
 #define FRAMEWORK_SCRIPT_REFERENCE_HPP
 
 #include <Framework/Script/Basic.hpp>
+#include <Framework/Script/BindingStatistics.hpp>
 #include <Framework/Script/Stack/StackBasic.hpp>
+#include <Framework/Script/TableRange.hpp>
+#include <Framework/Script/TypeTraits.hpp>
 #include <Framework/Script/VariableType.hpp>
 
+#include <exception>
 #include <memory>
+#include <ranges>
+#include <tuple>
+#include <vector>
 
 namespace Script
 {
 
+// What CallBatch does when a call raises an error.
+enum class BatchPolicy : uint8_t {
+	// Stops at the failed call, its error is the only one kept.
+	Stop,
+	// Counts the failure and continues.
+	Skip,
+	// Keeps every error and continues.
+	Collect,
+};
+
+struct BatchError
+{
+	size_t index = 0;
+	std::string message = {};
+};
+
+struct BatchResult
+{
+	size_t calls = 0;
+	size_t failed = 0;
+	std::vector< BatchError > errors = {};
+};
+
 class Reference final
 {
 public:
@@ -37,6 +67,14 @@ public:
 	template < typename... Args >
 	auto operator()(Args&&... args) const -> Reference;
 
+	// Calls the function once per element of arguments, an element is a single value or a tuple of values.
+	// The function is resolved once and the results are written in place of results[ i ],
+	// results of failed calls are left untouched.
+	template < typename Arguments >
+	auto CallBatch(const Arguments& arguments, BatchPolicy policy = BatchPolicy::Stop) const -> BatchResult;
+	template < typename Arguments, typename Results >
+	auto CallBatch(const Arguments& arguments, Results& results, BatchPolicy policy = BatchPolicy::Stop) const -> BatchResult;
+
 	template < typename Value >
 	auto operator=(const Value& value) -> Reference&;
 
@@ -45,6 +83,12 @@ public:
 	template < typename Return >
 	[[nodiscard]] auto Get() const -> Return;
 
+	// Lazy table ranges, values are converted while iterating.
+	template < typename Value >
+	[[nodiscard]] auto Array() const -> ArrayRange< Value >;
+	template < typename Key, typename Value >
+	[[nodiscard]] auto Pairs() const -> PairsRange< Key, Value >;
+
 	template < typename Key, typename Ret, typename... Args >
 	void SetField(const Key& key, Ret (*function)(Args... args));
 
@@ -58,6 +102,38 @@ public:
 
 	[[nodiscard]] inline auto GetId() const -> int32_t;
 
+private:
+	template < typename Key >
+	inline static void Instrument(lua_State*, const Key& key);
+
+	// Pushes the function, or the value itself when it has a __call metamethod,
+	// calling it then passes the value as first argument as Lua does.
+	void PushCallable(const char* context) const;
+
+	template < typename Item >
+	inline static void PushItem(lua_State*, const Item& item);
+
+	template < typename Arguments, typename Receive >
+	auto Batch(const Arguments& arguments, BatchPolicy policy, int32_t nresults, Receive receive) const -> BatchResult;
+
+	// Runs every call of a Stop batch under a single protected call: (function, state) -> nothing
+	template < typename Arguments, typename Receive >
+	struct BatchTrampoline
+	{
+		const Arguments& arguments;
+		Receive& receive;
+		int32_t nargs = 0;
+		int32_t nresults = 0;
+		size_t calls = 0;
+		std::exception_ptr exception = {};
+
+		static auto Run(lua_State* L) -> int32_t;
+
+		// C++ exceptions don't cross the protected call, they are kept and rethrown once it returned.
+		template < typename Function >
+		auto Guard(Function function) -> bool;
+	};
+
 private:
 	struct Pointer
 	{
@@ -119,7 +195,7 @@ auto Reference::operator()(Args&&... args) const -> Reference
 
 	Stack< void >::Push(L, std::forward< Args >(args)...);
 
-	if (lua_pcall(L, sizeof...(Args), 1, 0)) {
+	if (Utils::ProtectedCall(L, sizeof...(Args), 1, 0)) {
 		throw std::string("<Script::Reference::Call> ") + lua_tostring(L, -1);
 	}
 
@@ -128,6 +204,159 @@ auto Reference::operator()(Args&&... args) const -> Reference
 	return reference;
 }
 
+template < typename Arguments >
+auto Reference::CallBatch(const Arguments& arguments, const BatchPolicy policy) const -> BatchResult
+{
+	return Batch(arguments, policy, 0, [](lua_State*, const size_t) { });
+}
+
+template < typename Arguments, typename Results >
+auto Reference::CallBatch(const Arguments& arguments, Results& results, const BatchPolicy policy) const -> BatchResult
+{
+	using Return = std::ranges::range_value_t< Results >;
+
+	auto output = std::ranges::begin(results);
+	const auto end = std::ranges::end(results);
+	size_t position = 0;
+
+	return Batch(arguments, policy, 1, [ &output, &end, &position ](lua_State* L, const size_t index) {
+		for (; position < index && output != end; ++position) {
+			++output;
+		}
+		if (output != end) {
+			*output = Stack< Return >::Get(L, -1);
+		}
+	});
+}
+
+template < typename Item >
+void Reference::PushItem(lua_State* L, const Item& item)
+{
+	if constexpr (TypeTraits::IsTemplateBase< Item, std::tuple >::value) {
+		std::apply([ L ](const auto&... values) { Stack< void >::Push(L, values...); }, item);
+	} else {
+		Stack< Item >::Push(L, item);
+	}
+}
+
+template < typename Arguments, typename Receive >
+auto Reference::BatchTrampoline< Arguments, Receive >::Run(lua_State* L) -> int32_t
+{
+	using Item = typename TypeTraits::RemoveConstReference< std::ranges::range_reference_t< const Arguments > >::Type;
+
+	BatchTrampoline& state = *static_cast< BatchTrampoline* >(lua_touserdata(L, 2));
+	luaL_checkstack(L, state.nargs + state.nresults + 1, "<Script::Reference::CallBatch> stack overflow");
+
+	for (const Item& item : state.arguments) {
+		const size_t index = state.calls++;
+
+		lua_pushvalue(L, 1);
+		if (!state.Guard([ L, &item ]() { PushItem(L, item); })) {
+			return luaL_error(L, "<Script::Reference::CallBatch> C++ exception");
+		}
+
+		lua_call(L, state.nargs, state.nresults);
+		if (!state.Guard([ L, &state, index ]() { state.receive(L, index); })) {
+			return luaL_error(L, "<Script::Reference::CallBatch> C++ exception");
+		}
+		lua_settop(L, 2);
+	}
+	return 0;
+}
+
+template < typename Arguments, typename Receive >
+template < typename Function >
+auto Reference::BatchTrampoline< Arguments, Receive >::Guard(Function function) -> bool
+{
+	try {
+		function();
+		return true;
+	} catch (const std::string&) {
+		exception = std::current_exception();
+	} catch (const std::exception&) {
+		exception = std::current_exception();
+	}
+	return false;
+}
+
+template < typename Arguments, typename Receive >
+auto Reference::Batch(const Arguments& arguments, const BatchPolicy policy, const int32_t nresults, Receive receive) const -> BatchResult
+{
+	using Item = typename TypeTraits::RemoveConstReference< std::ranges::range_reference_t< const Arguments > >::Type;
+
+	lua_State* L = mPointer->L;
+	PushCallable("<Script::Reference::CallBatch>");
+	const int32_t function = lua_gettop(L);
+
+	int32_t nargs = 1;
+	if constexpr (TypeTraits::IsTemplateBase< Item, std::tuple >::value) {
+		nargs = static_cast< int32_t >(std::tuple_size_v< Item >);
+	}
+	luaL_checkstack(L, nargs + nresults + 1, "<Script::Reference::CallBatch> stack overflow");
+
+	BatchResult result = {};
+	const auto Fail = [ L, &result ](const size_t index, const bool keep) {
+		result.failed++;
+		if (keep) {
+			const char* message = lua_tostring(L, -1);
+			result.errors.push_back(BatchError{ .index = index, .message = message ? message : "(error object is not a string)" });
+		}
+	};
+
+	if (policy == BatchPolicy::Stop) {
+		using Trampoline = BatchTrampoline< Arguments, Receive >;
+		Trampoline state{ .arguments = arguments, .receive = receive, .nargs = nargs, .nresults = nresults };
+
+		lua_pushcfunction(L, &Trampoline::Run);
+		lua_pushvalue(L, function);
+		lua_pushlightuserdata(L, &state);
+		const int32_t status = Utils::ProtectedCall(L, 2, 0, 0);
+
+		result.calls = state.calls;
+		if (state.exception) {
+			lua_settop(L, function - 1);
+			std::rethrow_exception(state.exception);
+		}
+		if (status) {
+			// A stack overflow is raised before the first call.
+			Fail(state.calls ? state.calls - 1 : 0, true);
+		}
+
+		lua_settop(L, function - 1);
+		return result;
+	}
+
+	RuntimeCounters* counters = Utils::GetCounters(L);
+	for (const Item& item : arguments) {
+		const size_t index = result.calls++;
+
+		lua_pushvalue(L, function);
+		try {
+			PushItem(L, item);
+		} catch (...) {
+			lua_settop(L, function - 1);
+			throw;
+		}
+
+		if (Utils::ProtectedCall(L, counters, nargs, nresults, 0) == 0) {
+			try {
+				receive(L, index);
+			} catch (...) {
+				lua_settop(L, function - 1);
+				throw;
+			}
+			lua_settop(L, function);
+			continue;
+		}
+
+		Fail(index, policy == BatchPolicy::Collect);
+		lua_settop(L, function);
+	}
+
+	lua_settop(L, function - 1);
+	return result;
+}
+
 template < typename Value >
 auto Reference::operator=(const Value& value) -> Reference&
 {
@@ -155,6 +384,24 @@ auto Reference::Get() const -> Return
 	return ret;
 }
 
+template < typename Value >
+auto Reference::Array() const -> ArrayRange< Value >
+{
+	if (!mPointer) {
+		return {};
+	}
+	return ArrayRange< Value >{ mPointer, mPointer->L, mPointer->id };
+}
+
+template < typename Key, typename Value >
+auto Reference::Pairs() const -> PairsRange< Key, Value >
+{
+	if (!mPointer) {
+		return {};
+	}
+	return PairsRange< Key, Value >{ mPointer, mPointer->L, mPointer->id };
+}
+
 template < typename Key, typename Ret, typename... Args >
 void Reference::SetField(const Key& key, Ret (*function)(Args... args))
 {
@@ -163,6 +410,7 @@ void Reference::SetField(const Key& key, Ret (*function)(Args... args))
 
 	Stack< Key >::Push(L, key);
 	Stack< Ret (*)(Args...) >::Push(L, function);
+	Instrument(L, key);
 
 	lua_settable(L, -3);
 	lua_pop(L, 1);
@@ -176,11 +424,22 @@ void Reference::SetField(const Key& key, const Value& value)
 
 	Stack< Key >::Push(L, key);
 	Stack< Value >::Push(L, value);
+	Instrument(L, key);
 
 	lua_settable(L, -3);
 	lua_pop(L, 1);
 }
 
+template < typename Key >
+void Reference::Instrument([[maybe_unused]] lua_State* L, [[maybe_unused]] const Key& key)
+{
+#ifdef SCRIPT_BINDING_STATISTICS
+	if constexpr (std::is_convertible_v< Key, std::string_view >) {
+		BindingStatistics::Instrument(L, -3, key);
+	}
+#endif
+}
+
 template < typename Field >
 auto Reference::operator[](const Field& field) const -> Reference
 {
@@ -0,0 +1,364 @@
+#include <Framework/Script/Reloader.hpp>
+
+#include <Framework/Script/Engine.hpp>
+
+#include <cstring>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Script
+{
+
+namespace
+{
+
+constexpr int32_t MaxDepth = 8;
+
+void Backup(lua_State* L, const int32_t backup, const int32_t target, const int32_t key, const int32_t previous)
+{
+	lua_createtable(L, 3, 0);
+	lua_pushvalue(L, target);
+	lua_rawseti(L, -2, 1);
+	lua_pushvalue(L, key);
+	lua_rawseti(L, -2, 2);
+	lua_pushvalue(L, previous);
+	lua_rawseti(L, -2, 3);
+	lua_rawseti(L, backup, static_cast< int32_t >(lua_objlen(L, backup)) + 1);
+}
+
+// Copies functions and missing keys of source into target, recursing into tables both sides have.
+// Every new table is mapped to the one it was merged into, replaced functions are queued for Join.
+void Swap(lua_State* L, const int32_t target, const int32_t source, const int32_t backup,
+	const int32_t tables, const int32_t functions, const int32_t depth)
+{
+	luaL_checkstack(L, 8, "<Script::Reloader::Swap> stack overflow");
+
+	lua_pushvalue(L, source);
+	lua_pushvalue(L, target);
+	lua_rawset(L, tables);
+
+	lua_pushnil(L);
+	while (lua_next(L, source)) {
+		const int32_t key = lua_gettop(L) - 1;
+		const int32_t value = key + 1;
+
+		lua_pushvalue(L, key);
+		lua_rawget(L, target);
+		const int32_t previous = value + 1;
+
+		if (lua_isfunction(L, value) || lua_isnil(L, previous)) {
+			if (lua_isfunction(L, value)) {
+				lua_createtable(L, 2, 0);
+				lua_pushvalue(L, value);
+				lua_rawseti(L, -2, 1);
+				lua_pushvalue(L, previous);
+				lua_rawseti(L, -2, 2);
+				lua_rawseti(L, functions, static_cast< int32_t >(lua_objlen(L, functions)) + 1);
+			}
+
+			Backup(L, backup, target, key, previous);
+			lua_pushvalue(L, key);
+			lua_pushvalue(L, value);
+			lua_rawset(L, target);
+
+		} else if (lua_istable(L, value) && lua_istable(L, previous) && depth < MaxDepth) {
+			Swap(L, previous, value, backup, tables, functions, depth + 1);
+		}
+
+		lua_settop(L, key);
+	}
+}
+
+// Points the upvalues of a new function at the state of the function it replaces: data upvalues
+// with the same name are joined, tables merged by Swap are redirected to the table they were merged into.
+// Local helper functions are followed so they see the preserved state as well.
+void Join(lua_State* L, const int32_t function, const int32_t previous, const int32_t tables, const int32_t visited)
+{
+	if (!lua_isfunction(L, function) || lua_iscfunction(L, function)) {
+		return;
+	}
+
+	lua_pushvalue(L, function);
+	lua_rawget(L, visited);
+	const bool isVisited = lua_toboolean(L, -1);
+	lua_pop(L, 1);
+	if (isVisited) {
+		return;
+	}
+
+	lua_pushvalue(L, function);
+	lua_pushboolean(L, true);
+	lua_rawset(L, visited);
+
+	luaL_checkstack(L, 8, "<Script::Reloader::Join> stack overflow");
+	const bool hasPrevious = lua_isfunction(L, previous) && !lua_iscfunction(L, previous);
+
+	for (int32_t n = 1;; ++n) {
+		const char* name = lua_getupvalue(L, function, n);
+		if (!name) {
+			break;
+		}
+		const int32_t value = lua_gettop(L);
+
+		int32_t match = 0;
+		for (int32_t o = 1; hasPrevious; ++o) {
+			const char* previousName = lua_getupvalue(L, previous, o);
+			if (!previousName) {
+				break;
+			}
+			if (std::strcmp(name, previousName) == 0) {
+				match = o;
+				break;
+			}
+			lua_pop(L, 1);
+		}
+		if (!match) {
+			lua_pushnil(L);
+		}
+		const int32_t previousValue = value + 1;
+
+		if (lua_isfunction(L, value)) {
+			Join(L, value, previousValue, tables, visited);
+		} else if (match && !lua_isfunction(L, previousValue)) {
+			lua_upvaluejoin(L, function, n, previous, match);
+		} else if (lua_istable(L, value)) {
+			lua_pushvalue(L, value);
+			lua_rawget(L, tables);
+			if (!lua_isnil(L, -1)) {
+				lua_setupvalue(L, function, n);
+			}
+		}
+
+		lua_settop(L, value - 1);
+	}
+}
+
+} // namespace
+
+Reloader::Reloader(const Engine* engine)
+	: L(engine->State())
+{
+#ifdef __linux__
+	mDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+Reloader::~Reloader()
+{
+#ifdef __linux__
+	if (mDescriptor >= 0) {
+		close(mDescriptor);
+	}
+#endif
+}
+
+auto Reloader::Load(const std::string& name, const std::string& filename) -> Reference
+{
+	Module module{
+		.name = name,
+		.filename = std::filesystem::absolute(filename).lexically_normal(),
+	};
+
+	std::error_code code = {};
+	module.modified = std::filesystem::last_write_time(module.filename, code);
+
+	std::string error = {};
+	if (!Execute(module, error)) {
+		throw std::string{ "<Script::Reloader::Load> " } + error;
+	}
+
+	lua_getglobal(L, "package");
+	lua_getfield(L, -1, "loaded");
+	lua_pushvalue(L, -3);
+	lua_setfield(L, -2, name.c_str());
+	lua_pop(L, 2);
+
+	module.table = Reference{ L, -1, true };
+	Watch(module);
+
+	const Reference table = module.table;
+	mModules.insert_or_assign(name, std::move(module));
+	return table;
+}
+
+auto Reloader::Poll() -> size_t
+{
+	size_t count = 0;
+
+#ifdef __linux__
+	if (mDescriptor >= 0) {
+		std::unordered_set< std::string > changed = {};
+		alignas(inotify_event) char buffer[ 4096 ];
+
+		for (;;) {
+			const ssize_t length = read(mDescriptor, buffer, sizeof(buffer));
+			if (length <= 0) {
+				break;
+			}
+
+			for (ssize_t offset = 0; offset < length;) {
+				const inotify_event* event = reinterpret_cast< const inotify_event* >(buffer + offset);
+				if (event->len) {
+					if (const auto it = mDirectories.find(event->wd); it != mDirectories.end()) {
+						changed.insert((it->second / event->name).string());
+					}
+				}
+				offset += static_cast< ssize_t >(sizeof(inotify_event) + event->len);
+			}
+		}
+
+		for (auto& [ name, module ] : mModules) {
+			if (changed.contains(module.filename.string())) {
+				count += Reload(module) ? 1 : 0;
+			}
+		}
+		return count;
+	}
+#endif
+
+	for (auto& [ name, module ] : mModules) {
+		std::error_code code = {};
+		const std::filesystem::file_time_type modified = std::filesystem::last_write_time(module.filename, code);
+		if (!code && modified != module.modified) {
+			count += Reload(module) ? 1 : 0;
+		}
+	}
+	return count;
+}
+
+auto Reloader::Reload(const std::string& name) -> bool
+{
+	const auto it = mModules.find(name);
+	if (it == mModules.end()) {
+		return false;
+	}
+	return Reload(it->second);
+}
+
+auto Reloader::Rollback(const std::string& name) -> bool
+{
+	const auto it = mModules.find(name);
+	if (it == mModules.end() || !it->second.backup) {
+		return false;
+	}
+
+	Module& module = it->second;
+	module.backup.Push();
+	const int32_t backup = lua_gettop(L);
+
+	for (int32_t i = static_cast< int32_t >(lua_objlen(L, backup)); i > 0; --i) {
+		lua_rawgeti(L, backup, i);
+		lua_rawgeti(L, -1, 1);
+		lua_rawgeti(L, -2, 2);
+		lua_rawgeti(L, -3, 3);
+		lua_rawset(L, -3);
+		lua_pop(L, 2);
+	}
+	lua_pop(L, 1);
+
+	module.backup = {};
+	Notify(module, true, true, {});
+	return true;
+}
+
+void Reloader::SetCallback(Callback callback)
+{
+	mCallback = std::move(callback);
+}
+
+auto Reloader::Execute(const Module& module, std::string& error) const -> bool
+{
+	const int32_t top = lua_gettop(L);
+
+	if (luaL_loadfile(L, module.filename.c_str()) || lua_pcall(L, 0, 1, 0)) {
+		error = lua_tostring(L, -1);
+		lua_settop(L, top);
+		return false;
+	}
+
+	if (!lua_istable(L, -1)) {
+		error = module.filename.string() + ": module must return a table";
+		lua_settop(L, top);
+		return false;
+	}
+	return true;
+}
+
+auto Reloader::Reload(Module& module) -> bool
+{
+	std::error_code code = {};
+	module.modified = std::filesystem::last_write_time(module.filename, code);
+
+	std::string error = {};
+	if (!Execute(module, error)) {
+		Notify(module, false, false, error);
+		return false;
+	}
+
+	const int32_t source = lua_gettop(L);
+	module.table.Push();
+	const int32_t target = source + 1;
+	lua_newtable(L);
+	const int32_t backup = source + 2;
+	lua_newtable(L);
+	const int32_t tables = source + 3;
+	lua_newtable(L);
+	const int32_t functions = source + 4;
+	lua_newtable(L);
+	const int32_t visited = source + 5;
+
+	Swap(L, target, source, backup, tables, functions, 0);
+
+	for (int32_t i = 1; i <= static_cast< int32_t >(lua_objlen(L, functions)); ++i) {
+		lua_rawgeti(L, functions, i);
+		lua_rawgeti(L, -1, 1);
+		lua_rawgeti(L, -2, 2);
+		Join(L, lua_gettop(L) - 1, lua_gettop(L), tables, visited);
+		lua_pop(L, 3);
+	}
+
+	lua_pushvalue(L, backup);
+	module.backup = Reference{ L, -1, true };
+	lua_settop(L, source - 1);
+
+	Notify(module, true, false, {});
+	return true;
+}
+
+void Reloader::Watch(const Module& module)
+{
+#ifdef __linux__
+	if (mDescriptor < 0) {
+		return;
+	}
+
+	const std::filesystem::path directory = module.filename.parent_path();
+	const int32_t watch = inotify_add_watch(mDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (watch >= 0) {
+		mDirectories[ watch ] = directory;
+	}
+#else
+	static_cast< void >(module);
+#endif
+}
+
+void Reloader::Notify(const Module& module, const bool success, const bool rollback, const std::string& error) const
+{
+	if (!mCallback) {
+		return;
+	}
+
+	mCallback(ReloadEvent{
+		.name = module.name,
+		.filename = module.filename.string(),
+		.success = success,
+		.rollback = rollback,
+		.error = error,
+	});
+}
+
+} // namespace Script
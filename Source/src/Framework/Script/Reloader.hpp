@@ -0,0 +1,82 @@
+#ifndef FRAMEWORK_SCRIPT_RELOADER_HPP
+#define FRAMEWORK_SCRIPT_RELOADER_HPP
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <Framework/Script/Reference.hpp>
+
+namespace Script
+{
+
+class Engine;
+
+struct ReloadEvent
+{
+	std::string name = {};
+	std::string filename = {};
+	bool success = false;
+	bool rollback = false;
+	std::string error = {};
+};
+
+// Watches files loaded as modules and swaps changed ones into the running engine.
+// A module is a chunk returning a table, kept in package.loaded so require() finds it.
+// On reload the chunk runs again into a fresh table, then its functions replace the old
+// ones in place and keys the old table lacks are added; data already in the module is
+// left alone. New functions share the upvalues of the functions they replace, so module
+// locals keep their state. A failed compile or run leaves the module untouched.
+// Changes are detected with inotify on Linux and by modification time elsewhere.
+class Reloader final
+{
+public:
+	using Callback = std::function< void(const ReloadEvent&) >;
+
+	explicit Reloader(const Engine*);
+	Reloader(const Reloader&) = delete;
+	Reloader(Reloader&&) = delete;
+	Reloader& operator=(const Reloader&) = delete;
+	Reloader& operator=(Reloader&&) = delete;
+	~Reloader();
+
+	auto Load(const std::string& name, const std::string& filename) -> Reference;
+
+	// Reloads modules whose files changed since the last poll, returns how many were swapped in.
+	auto Poll() -> size_t;
+	auto Reload(const std::string& name) -> bool;
+	// Restores the fields replaced by the last successful reload.
+	auto Rollback(const std::string& name) -> bool;
+
+	void SetCallback(Callback callback);
+
+private:
+	struct Module
+	{
+		std::string name = {};
+		std::filesystem::path filename = {};
+		std::filesystem::file_time_type modified = {};
+		Reference table = {};
+		Reference backup = {};
+	};
+
+	[[nodiscard]] auto Execute(const Module&, std::string& error) const -> bool;
+	auto Reload(Module&) -> bool;
+	void Watch(const Module&);
+	void Notify(const Module&, bool success, bool rollback, const std::string& error) const;
+
+private:
+	lua_State* L = {};
+	int32_t mDescriptor = -1;
+	std::unordered_map< int32_t, std::filesystem::path > mDirectories = {};
+	std::unordered_map< std::string, Module > mModules = {};
+	Callback mCallback = {};
+};
+
+using ReloaderPtr = std::shared_ptr< Reloader >;
+
+} // namespace Script
+
+#endif
@@ -20,6 +20,8 @@ Sandbox::Sandbox(const Engine* engine, std::string_view sandbox)
 	lua_newtable(L);
 	lua_getglobal(L, "_G");
 	lua_setfield(L, -2, "__index");
+	lua_pushlstring(L, sandbox.data(), sandbox.size());
+	lua_setfield(L, -2, "__name");
 	lua_setmetatable(L, -2);
 	lua_pop(L, 1);
 
@@ -0,0 +1,451 @@
+#include <Framework/Script/SharedData.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <new>
+#include <unordered_map>
+
+namespace Script
+{
+
+namespace
+{
+
+constexpr const char* ViewMetatable = "ScriptSharedData";
+
+// A view without data was collected, scripts may still call __gc or any method on it.
+struct View
+{
+	SharedDataPtr data = {};
+	uint32_t index = 0;
+};
+
+auto GetView(lua_State* L) -> View&
+{
+	View& view = *static_cast< View* >(luaL_checkudata(L, 1, ViewMetatable));
+	if (!view.data) {
+		luaL_error(L, "<Script::SharedData> View was collected");
+	}
+	return view;
+}
+
+// Keys order by type first: booleans, numbers, strings.
+auto GetRank(const SharedData::Node& node) -> int32_t
+{
+	if (std::holds_alternative< bool >(node.value)) {
+		return 0;
+	} else if (std::holds_alternative< double >(node.value)) {
+		return 1;
+	} else if (std::holds_alternative< std::string >(node.value)) {
+		return 2;
+	}
+	throw std::string{ "<Script::SharedData::SharedData> Keys must be booleans, numbers or strings" };
+}
+
+auto IsLess(const SharedData::Node& left, const SharedData::Node& right) -> bool
+{
+	const int32_t leftRank = GetRank(left);
+	const int32_t rightRank = GetRank(right);
+	if (leftRank != rightRank) {
+		return leftRank < rightRank;
+	}
+	if (leftRank == 0) {
+		return std::get< bool >(left.value) < std::get< bool >(right.value);
+	} else if (leftRank == 1) {
+		return std::get< double >(left.value) < std::get< double >(right.value);
+	}
+	return std::get< std::string >(left.value) < std::get< std::string >(right.value);
+}
+
+template < typename Type >
+auto Compare(const Type& left, const Type& right) -> int32_t
+{
+	return (left < right) ? -1 : (right < left) ? 1 : 0;
+}
+
+} // namespace
+
+struct SharedData::Builder
+{
+	SharedData& data;
+	std::unordered_map< std::string, uint32_t > strings = {};
+
+	auto Intern(const std::string& value) -> uint32_t
+	{
+		const auto [ it, inserted ] = strings.emplace(value, static_cast< uint32_t >(data.mStrings.size()));
+		if (inserted) {
+			data.mStrings.append(value);
+		}
+		return it->second;
+	}
+
+	auto Reserve(const size_t count) -> uint32_t
+	{
+		const size_t offset = data.mValues.size();
+		if (offset + count > std::numeric_limits< uint32_t >::max() ||
+			data.mStrings.size() > std::numeric_limits< uint32_t >::max()) {
+			throw std::string{ "<Script::SharedData::SharedData> Data is too large" };
+		}
+		data.mValues.resize(offset + count);
+		return static_cast< uint32_t >(offset);
+	}
+
+	void Build(const Node& node, const uint32_t slot)
+	{
+		Value value = {};
+
+		if (const bool* boolean = std::get_if< bool >(&node.value)) {
+			value = Value{ .type = ValueType::Boolean, .payload = *boolean };
+
+		} else if (const double* number = std::get_if< double >(&node.value)) {
+			value = Value{ .type = ValueType::Number, .payload = std::bit_cast< uint64_t >(*number) };
+
+		} else if (const std::string* string = std::get_if< std::string >(&node.value)) {
+			value = Value{ .type = ValueType::String, .size = static_cast< uint32_t >(string->size()), .payload = Intern(*string) };
+
+		} else if (const Node::Table* table = std::get_if< Node::Table >(&node.value)) {
+			BuildTable(*table, slot);
+			return;
+		}
+
+		data.mValues[ slot ] = value;
+	}
+
+	void BuildTable(const Node::Table& table, const uint32_t slot)
+	{
+		std::map< uint64_t, const Node* > integers = {};
+		std::vector< std::pair< const Node*, const Node* > > pairs = {};
+
+		for (const auto& [ key, value ] : table) {
+			if (std::holds_alternative< std::monostate >(value.value)) {
+				continue;
+			}
+
+			const double* number = std::get_if< double >(&key.value);
+			if (number && std::isnan(*number)) {
+				throw std::string{ "<Script::SharedData::SharedData> Keys can't be NaN" };
+			}
+			if (number && *number >= 1 && *number <= std::numeric_limits< uint32_t >::max() && std::floor(*number) == *number) {
+				if (!integers.emplace(static_cast< uint64_t >(*number), &value).second) {
+					throw std::string{ "<Script::SharedData::SharedData> Duplicate key" };
+				}
+				continue;
+			}
+			static_cast< void >(GetRank(key));
+			pairs.emplace_back(&key, &value);
+		}
+
+		std::vector< const Node* > array = {};
+		for (const auto& [ index, value ] : integers) {
+			if (index != array.size() + 1) {
+				break;
+			}
+			array.push_back(value);
+		}
+
+		// Integer keys past the array part become number keys so they sort with the others.
+		std::vector< Node > integerKeys = {};
+		integerKeys.reserve(integers.size());
+		for (auto it = integers.upper_bound(array.size()); it != integers.end(); ++it) {
+			integerKeys.emplace_back(static_cast< double >(it->first));
+			pairs.emplace_back(&integerKeys.back(), it->second);
+		}
+
+		std::sort(pairs.begin(), pairs.end(), [](const auto& left, const auto& right) {
+			return IsLess(*left.first, *right.first);
+		});
+		const auto duplicate = std::adjacent_find(pairs.begin(), pairs.end(), [](const auto& left, const auto& right) {
+			return !IsLess(*left.first, *right.first);
+		});
+		if (duplicate != pairs.end()) {
+			throw std::string{ "<Script::SharedData::SharedData> Duplicate key" };
+		}
+
+		const uint32_t size = static_cast< uint32_t >(array.size());
+		const uint32_t count = static_cast< uint32_t >(pairs.size());
+		const uint32_t offset = Reserve(size + count * 2);
+		data.mValues[ slot ] = Value{
+			.type = ValueType::Table,
+			.size = size,
+			.payload = offset | (static_cast< uint64_t >(count) << 32),
+		};
+
+		for (uint32_t i = 0; i < size; ++i) {
+			Build(*array[ i ], offset + i);
+		}
+		for (uint32_t i = 0; i < count; ++i) {
+			Build(*pairs[ i ].first, offset + size + i);
+			Build(*pairs[ i ].second, offset + size + count + i);
+		}
+	}
+};
+
+auto SharedData::Node::Array(std::vector< Node > nodes) -> Node
+{
+	Table table = {};
+	table.reserve(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		table.emplace_back(Node{ i + 1 }, std::move(nodes[ i ]));
+	}
+	return Node{ std::move(table) };
+}
+
+SharedData::SharedData(const Node& root)
+{
+	Builder builder{ .data = *this };
+	builder.Reserve(1);
+	builder.Build(root, 0);
+
+	mValues.shrink_to_fit();
+	mStrings.shrink_to_fit();
+}
+
+auto SharedData::GetMemoryUsage() const -> size_t
+{
+	return sizeof(SharedData) + mValues.capacity() * sizeof(Value) + mStrings.capacity();
+}
+
+auto SharedData::GetString(const Value& value) const -> std::string_view
+{
+	return std::string_view{ mStrings.data() + value.payload, value.size };
+}
+
+auto SharedData::GetOffset(const Value& value) -> uint32_t
+{
+	return static_cast< uint32_t >(value.payload);
+}
+
+auto SharedData::GetPairs(const Value& value) -> uint32_t
+{
+	return static_cast< uint32_t >(value.payload >> 32);
+}
+
+auto SharedData::Find(const Value& table, lua_State* L, const int32_t idx) const -> int64_t
+{
+	ValueType type = ValueType::Nil;
+	bool boolean = false;
+	lua_Number number = 0;
+	std::string_view string = {};
+
+	switch (lua_type(L, idx)) {
+		case LUA_TBOOLEAN:
+			type = ValueType::Boolean;
+			boolean = lua_toboolean(L, idx);
+			break;
+
+		case LUA_TNUMBER:
+			type = ValueType::Number;
+			number = lua_tonumber(L, idx);
+			if (number >= 1 && number <= table.size && std::floor(number) == number) {
+				return static_cast< int64_t >(number) - 1;
+			}
+			break;
+
+		case LUA_TSTRING: {
+			type = ValueType::String;
+			size_t length = 0;
+			const char* value = lua_tolstring(L, idx, &length);
+			string = std::string_view{ value, length };
+			break;
+		}
+
+		default:
+			return -1;
+	}
+
+	const Value* keys = mValues.data() + GetOffset(table) + table.size;
+	uint32_t low = 0;
+	uint32_t high = GetPairs(table);
+
+	while (low < high) {
+		const uint32_t middle = low + (high - low) / 2;
+		const Value& key = keys[ middle ];
+
+		int32_t order = Compare(key.type, type);
+		if (order == 0) {
+			if (type == ValueType::Boolean) {
+				order = Compare(key.payload != 0, boolean);
+			} else if (type == ValueType::Number) {
+				order = Compare(std::bit_cast< double >(key.payload), number);
+			} else {
+				order = Compare(GetString(key), string);
+			}
+		}
+
+		if (order < 0) {
+			low = middle + 1;
+		} else if (order > 0) {
+			high = middle;
+		} else {
+			return static_cast< int64_t >(table.size) + middle;
+		}
+	}
+
+	return -1;
+}
+
+void SharedData::PushValue(lua_State* L, const SharedDataPtr& self, const uint32_t index) const
+{
+	const Value& value = mValues[ index ];
+
+	switch (value.type) {
+		case ValueType::Nil:
+			lua_pushnil(L);
+			return;
+
+		case ValueType::Boolean:
+			lua_pushboolean(L, value.payload != 0);
+			return;
+
+		case ValueType::Number:
+			lua_pushnumber(L, std::bit_cast< double >(value.payload));
+			return;
+
+		case ValueType::String: {
+			const std::string_view string = GetString(value);
+			lua_pushlstring(L, string.data(), string.size());
+			return;
+		}
+
+		case ValueType::Table:
+			PushView(L, self, index);
+			return;
+	}
+}
+
+void SharedData::PushView(lua_State* L, const SharedDataPtr& self, const uint32_t index)
+{
+	new (lua_newuserdata(L, sizeof(View))) View{ .data = self, .index = index };
+
+	if (luaL_newmetatable(L, ViewMetatable)) {
+		lua_pushcfunction(L, Collect);
+		lua_setfield(L, -2, "__gc");
+		lua_pushcfunction(L, Index);
+		lua_setfield(L, -2, "__index");
+		lua_pushcfunction(L, NewIndex);
+		lua_setfield(L, -2, "__newindex");
+		lua_pushcfunction(L, Length);
+		lua_setfield(L, -2, "__len");
+		lua_pushcfunction(L, Call);
+		lua_setfield(L, -2, "__call");
+		lua_pushstring(L, ViewMetatable);
+		lua_setfield(L, -2, "__name");
+	}
+	lua_setmetatable(L, -2);
+}
+
+auto SharedData::Collect(lua_State* L) -> int32_t
+{
+	// An empty view owns nothing and needs no destructor.
+	static_cast< View* >(luaL_checkudata(L, 1, ViewMetatable))->data.reset();
+	return 0;
+}
+
+auto SharedData::Index(lua_State* L) -> int32_t
+{
+	const View& view = GetView(L);
+	const SharedData& data = *view.data;
+	const Value& table = data.mValues[ view.index ];
+
+	const int64_t position = data.Find(table, L, 2);
+	if (position < 0) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const uint32_t offset = GetOffset(table);
+	const uint32_t slot = (position < table.size) ? offset + static_cast< uint32_t >(position)
+												  : offset + GetPairs(table) + static_cast< uint32_t >(position);
+	data.PushValue(L, view.data, slot);
+	return 1;
+}
+
+auto SharedData::NewIndex(lua_State* L) -> int32_t
+{
+	return luaL_error(L, "<Script::SharedData::NewIndex> Shared data is read-only");
+}
+
+auto SharedData::Length(lua_State* L) -> int32_t
+{
+	const View& view = GetView(L);
+	lua_pushinteger(L, static_cast< lua_Integer >(view.data->mValues[ view.index ].size));
+	return 1;
+}
+
+auto SharedData::Call(lua_State* L) -> int32_t
+{
+	static_cast< void >(GetView(L));
+	lua_pushcfunction(L, Next);
+	lua_pushvalue(L, 1);
+	lua_pushnil(L);
+	return 3;
+}
+
+auto SharedData::Next(lua_State* L) -> int32_t
+{
+	const View& view = GetView(L);
+	const SharedData& data = *view.data;
+	const Value& table = data.mValues[ view.index ];
+
+	int64_t position = 0;
+	if (!lua_isnoneornil(L, 2)) {
+		position = data.Find(table, L, 2);
+		if (position < 0) {
+			return luaL_error(L, "<Script::SharedData::Next> Invalid key to 'next'");
+		}
+		++position;
+	}
+
+	const uint32_t offset = GetOffset(table);
+	const uint32_t pairs = GetPairs(table);
+	if (position >= static_cast< int64_t >(table.size) + pairs) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const uint32_t index = static_cast< uint32_t >(position);
+	if (index < table.size) {
+		lua_pushinteger(L, static_cast< lua_Integer >(index) + 1);
+		data.PushValue(L, view.data, offset + index);
+	} else {
+		data.PushValue(L, view.data, offset + index);
+		data.PushValue(L, view.data, offset + pairs + index);
+	}
+	return 2;
+}
+
+////////////////      Stack     ////////////////
+
+auto Stack< SharedDataPtr >::Get(lua_State* L, const int32_t idx) -> SharedDataPtr
+{
+	if (!Is(L, idx)) {
+		return nullptr;
+	}
+	return static_cast< View* >(lua_touserdata(L, idx))->data;
+}
+
+void Stack< SharedDataPtr >::Push(lua_State* L, const SharedDataPtr& data)
+{
+	if (!data) {
+		lua_pushnil(L);
+		return;
+	}
+	SharedData::PushView(L, data, 0);
+}
+
+auto Stack< SharedDataPtr >::Is(lua_State* L, const int32_t idx) -> bool
+{
+	if (lua_type(L, idx) != LUA_TUSERDATA || !lua_getmetatable(L, idx)) {
+		return false;
+	}
+
+	luaL_getmetatable(L, ViewMetatable);
+	const bool is = lua_rawequal(L, -1, -2);
+	lua_pop(L, 2);
+	return is;
+}
+
+} // namespace Script
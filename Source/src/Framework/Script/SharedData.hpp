@@ -0,0 +1,113 @@
+#ifndef FRAMEWORK_SCRIPT_SHAREDDATA_HPP
+#define FRAMEWORK_SCRIPT_SHAREDDATA_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <Framework/Script/Stack/StackBasic.hpp>
+
+namespace Script
+{
+
+// Immutable data built once and shared by any number of engines, possibly on different threads.
+// The tree is flattened into one value array and one string pool, scripts read it through
+// read-only userdata views, so no engine copies it and the collector never traces its contents:
+//   data.items[ 1 ].name, #data.items, for key, value in data.items() do ... end
+class SharedData final
+{
+public:
+	struct Node
+	{
+		using Table = std::vector< std::pair< Node, Node > >;
+
+		Node() = default;
+		Node(const bool value)
+			: value(value) { }
+		template < typename Type >
+			requires(std::is_arithmetic_v< Type > && !std::is_same_v< Type, bool >)
+		Node(const Type value)
+			: value(static_cast< double >(value)) { }
+		Node(const char* value)
+			: value(std::string{ value }) { }
+		Node(std::string value)
+			: value(std::move(value)) { }
+		Node(Table value)
+			: value(std::move(value)) { }
+
+		// Table with the given nodes at keys 1..n.
+		[[nodiscard]] static auto Array(std::vector< Node > nodes) -> Node;
+
+		std::variant< std::monostate, bool, double, std::string, Table > value = {};
+	};
+
+	explicit SharedData(const Node& root);
+	SharedData(const SharedData&) = delete;
+	SharedData(SharedData&&) = delete;
+	SharedData& operator=(const SharedData&) = delete;
+	SharedData& operator=(SharedData&&) = delete;
+	~SharedData() = default;
+
+	[[nodiscard]] auto GetMemoryUsage() const -> size_t;
+
+private:
+	enum class ValueType : uint8_t {
+		Nil = 0,
+		Boolean = 1,
+		Number = 2,
+		String = 3,
+		Table = 4,
+	};
+
+	// Strings keep their pool offset in payload, tables their first slot in the low
+	// and hash part size in the high half. Table slots hold the array part followed
+	// by the sorted hash keys and then their values.
+	struct Value
+	{
+		ValueType type = ValueType::Nil;
+		uint32_t size = 0;
+		uint64_t payload = 0;
+	};
+
+	struct Builder;
+	friend struct Stack< std::shared_ptr< SharedData > >;
+
+	[[nodiscard]] auto GetString(const Value&) const -> std::string_view;
+	[[nodiscard]] static auto GetOffset(const Value&) -> uint32_t;
+	[[nodiscard]] static auto GetPairs(const Value&) -> uint32_t;
+
+	// Returns the slot of key at idx within table, or -1.
+	[[nodiscard]] auto Find(const Value& table, lua_State*, int32_t idx) const -> int64_t;
+	void PushValue(lua_State*, const std::shared_ptr< SharedData >& self, uint32_t index) const;
+
+	static void PushView(lua_State*, const std::shared_ptr< SharedData >& self, uint32_t index);
+	static auto Collect(lua_State*) -> int32_t;
+	static auto Index(lua_State*) -> int32_t;
+	static auto NewIndex(lua_State*) -> int32_t;
+	static auto Length(lua_State*) -> int32_t;
+	static auto Call(lua_State*) -> int32_t;
+	static auto Next(lua_State*) -> int32_t;
+
+private:
+	std::vector< Value > mValues = {};
+	std::string mStrings = {};
+};
+
+using SharedDataPtr = std::shared_ptr< SharedData >;
+
+template <>
+struct Stack< SharedDataPtr >
+{
+	static SharedDataPtr Get(lua_State* L, const int32_t idx);
+	static void Push(lua_State* L, const SharedDataPtr& data);
+	static bool Is(lua_State* L, const int32_t idx);
+};
+
+} // namespace Script
+
+#endif
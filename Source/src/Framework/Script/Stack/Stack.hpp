@@ -1,10 +1,12 @@
 #ifndef FRAMEWORK_SCRIPT_STACK_STAC_HPP
 #define FRAMEWORK_SCRIPT_STACK_STAC_HPP
 
+#include <Framework/Script/Stack/StackAggregate.hpp>
 #include <Framework/Script/Stack/StackArguments.hpp>
 #include <Framework/Script/Stack/StackBasic.hpp>
 #include <Framework/Script/Stack/StackClass.hpp>
 #include <Framework/Script/Stack/StackContainer.hpp>
 #include <Framework/Script/Stack/StackFunction.hpp>
+#include <Framework/Script/Stack/StackProxy.hpp>
 
 #endif
@@ -0,0 +1,116 @@
+#ifndef FRAMEWORK_SCRIPT_STACK_STACKAGGREGATE_HPP
+#define FRAMEWORK_SCRIPT_STACK_STACKAGGREGATE_HPP
+
+#include <Framework/Script/Key.hpp>
+#include <Framework/Script/Stack/StackBasic.hpp>
+#include <Framework/Script/TypeTraits.hpp>
+
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace Script
+{
+
+template < class Class, typename Member >
+struct Field
+{
+	std::string_view name;
+	Member Class::*member;
+	int32_t (*key)();
+};
+
+// Field descriptor of an aggregate, specialized by SCRIPT_FIELDS.
+template < class Type >
+struct Fields
+{
+	static constexpr bool Enabled = false;
+};
+
+template < class Type >
+struct Stack< Type, std::enable_if_t< Fields< Type >::Enabled > >
+{
+	static constexpr auto Members = Fields< Type >::Members;
+	static constexpr size_t Size = std::tuple_size_v< decltype(Members) >;
+
+	static Type Get(lua_State* L, int32_t idx)
+	{
+		Type value = {};
+		if (!lua_istable(L, idx)) {
+			return value;
+		}
+
+		idx = idx < 0 ? lua_gettop(L) + idx + 1 : idx;
+		Keys::PushTable(L);
+		GetFields(L, idx, value, std::make_index_sequence< Size >{});
+		lua_pop(L, 1);
+		return value;
+	}
+
+	static void Push(lua_State* L, const Type& value)
+	{
+		Keys::PushTable(L);
+		lua_createtable(L, 0, static_cast< int32_t >(Size));
+		PushFields(L, value, std::make_index_sequence< Size >{});
+		lua_remove(L, -2);
+	}
+
+	static bool Is(lua_State* L, const int32_t idx) { return lua_istable(L, idx); }
+
+private:
+	template < size_t... Index >
+	static void PushFields(lua_State* L, const Type& value, std::index_sequence< Index... >)
+	{
+		(PushField(L, value, std::get< Index >(Members)), ...);
+	}
+
+	template < size_t... Index >
+	static void GetFields(lua_State* L, const int32_t idx, Type& value, std::index_sequence< Index... >)
+	{
+		(GetField(L, idx, value, std::get< Index >(Members)), ...);
+	}
+
+	template < typename Member >
+	static void PushField(lua_State* L, const Type& value, const Field< Type, Member >& field)
+	{
+		Keys::Push(L, -2, field.key(), field.name);
+		Stack< Member >::Push(L, value.*(field.member));
+		lua_rawset(L, -3);
+	}
+
+	template < typename Member >
+	static void GetField(lua_State* L, const int32_t idx, Type& value, const Field< Type, Member >& field)
+	{
+		Keys::Push(L, -1, field.key(), field.name);
+		lua_rawget(L, idx);
+		if (!lua_isnil(L, -1)) {
+			value.*(field.member) = Stack< Member >::Get(L, -1);
+		}
+		lua_pop(L, 1);
+	}
+};
+
+} // namespace Script
+
+#define SCRIPT_FIELDS_PARENS ()
+
+#define SCRIPT_FIELDS_EXPAND(...) SCRIPT_FIELDS_EXPAND3(SCRIPT_FIELDS_EXPAND3(SCRIPT_FIELDS_EXPAND3(SCRIPT_FIELDS_EXPAND3(__VA_ARGS__))))
+#define SCRIPT_FIELDS_EXPAND3(...) SCRIPT_FIELDS_EXPAND2(SCRIPT_FIELDS_EXPAND2(SCRIPT_FIELDS_EXPAND2(SCRIPT_FIELDS_EXPAND2(__VA_ARGS__))))
+#define SCRIPT_FIELDS_EXPAND2(...) SCRIPT_FIELDS_EXPAND1(SCRIPT_FIELDS_EXPAND1(SCRIPT_FIELDS_EXPAND1(SCRIPT_FIELDS_EXPAND1(__VA_ARGS__))))
+#define SCRIPT_FIELDS_EXPAND1(...) __VA_ARGS__
+
+#define SCRIPT_FIELDS_FOR_EACH(Type, ...) __VA_OPT__(SCRIPT_FIELDS_EXPAND(SCRIPT_FIELDS_FOR_EACH_HELPER(Type, __VA_ARGS__)))
+#define SCRIPT_FIELDS_FOR_EACH_HELPER(Type, field, ...) \
+	::Script::Field< Type, decltype(Type::field) >{ #field, &Type::field, &::Script::Key< #field >::Index }, __VA_OPT__(SCRIPT_FIELDS_FOR_EACH_AGAIN SCRIPT_FIELDS_PARENS(Type, __VA_ARGS__))
+#define SCRIPT_FIELDS_FOR_EACH_AGAIN() SCRIPT_FIELDS_FOR_EACH_HELPER
+
+// Declares the script visible fields of an aggregate, must be used at global namespace scope.
+#define SCRIPT_FIELDS(Type, ...)                                                        \
+	template <>                                                                         \
+	struct Script::Fields< Type >                                                       \
+	{                                                                                   \
+		static constexpr bool Enabled = true;                                           \
+		static constexpr std::tuple Members = { SCRIPT_FIELDS_FOR_EACH(Type, __VA_ARGS__) }; \
+	}
+
+#endif
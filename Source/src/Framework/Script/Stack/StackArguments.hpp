@@ -1,14 +1,35 @@
 #ifndef FRAMEWORK_SCRIPT_STACKARGUMENTS_HPP
 #define FRAMEWORK_SCRIPT_STACKARGUMENTS_HPP
 
+#include <Framework/Script/Basic.hpp>
 #include <Framework/Script/Stack/StackBasic.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <type_traits>
 
 namespace Script
 {
 
+// Class of the object arguments taken by pointer or shared pointer, void for other arguments.
+template < typename T, typename = void >
+struct ArgumentClass
+{
+	using Type = void;
+};
+
+template < typename T >
+struct ArgumentClass< T*, std::enable_if_t< std::is_class_v< T > > >
+{
+	using Type = std::remove_cv_t< T >;
+};
+
+template < typename T >
+struct ArgumentClass< std::shared_ptr< T > >
+{
+	using Type = std::remove_cv_t< T >;
+};
+
 template < size_t Size >
 struct StackArguments
 {
@@ -18,7 +39,7 @@ struct StackArguments
 		const int32_t currentArgIndex = static_cast< int32_t >(std::tuple_size< Tuple >::value - Size);
 
 		if (topArgsNum > currentArgIndex) {
-			Get(L, std::get< std::tuple_size< Tuple >::value - Size >(tuple), (-topArgsNum + currentArgIndex));
+			Get(L, std::get< std::tuple_size< Tuple >::value - Size >(tuple), (-topArgsNum + currentArgIndex), currentArgIndex + 1);
 		}
 
 		StackArguments< Size - 1 >(L, tuple, topArgsNum);
@@ -26,9 +47,17 @@ struct StackArguments
 
 private:
 	template < typename T >
-	inline static void Get(lua_State* L, T& value, const int32_t idx)
+	inline static void Get(lua_State* L, T& value, const int32_t idx, const int32_t argument)
 	{
 		value = Stack< T >::Get(L, idx);
+
+		// A value that isn't an object of the class is an error rather than a null pointer, nil still is one.
+		if constexpr (!std::is_void_v< typename ArgumentClass< T >::Type >) {
+			if (!value && !lua_isnil(L, idx)) {
+				const std::string name = Utils::DemangleClassName< typename ArgumentClass< T >::Type >();
+				luaL_error(L, "<Script::StackArguments> Argument #%d is not a '%s'", argument, name.c_str());
+			}
+		}
 	}
 };
 
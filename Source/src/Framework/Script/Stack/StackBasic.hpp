@@ -95,16 +95,21 @@ struct Stack< Type, typename std::enable_if_t< TypeTraits::IsCharPointer< Type >
 template <>
 struct Stack< std::string >
 {
-	static std::string Get(lua_State* L, const int32_t idx) { return std::string{ lua_tolstring(L, idx, nullptr) }; }
-	static void Push(lua_State* L, const std::string& value) { lua_pushstring(L, value.c_str()); }
+	static std::string Get(lua_State* L, const int32_t idx)
+	{
+		size_t length = 0;
+		const char* value = lua_tolstring(L, idx, &length);
+		return value ? std::string{ value, length } : std::string{};
+	}
+	static void Push(lua_State* L, const std::string& value) { lua_pushlstring(L, value.data(), value.size()); }
 	static bool Is(lua_State* L, const int32_t idx) { return (lua_type(L, idx) == LUA_TSTRING); }
 };
 
 template <>
 struct Stack< std::string_view >
 {
-	static std::string Get(lua_State* L, const int32_t idx) { return std::string{ lua_tolstring(L, idx, nullptr) }; }
-	static void Push(lua_State* L, const std::string_view& value) { lua_pushstring(L, value.data()); }
+	static std::string Get(lua_State* L, const int32_t idx) { return Stack< std::string >::Get(L, idx); }
+	static void Push(lua_State* L, const std::string_view& value) { lua_pushlstring(L, value.data(), value.size()); }
 	static bool Is(lua_State* L, const int32_t idx) { return (lua_type(L, idx) == LUA_TSTRING); }
 };
 
@@ -17,20 +17,35 @@ struct Stack< Class*, std::enable_if_t< std::is_class_v< Class > > >
 		const VariableType type = static_cast< VariableType >(lua_type(L, idx));
 
 		if (type == VariableType::UserData) {
-			ObjectOwnership** pointer = static_cast< ObjectOwnership** >(lua_touserdata(L, idx));
-			if constexpr (std::is_base_of_v< Object, Class >) {
-				return dynamic_cast< Class* >((*pointer)->Get().get());
-			} else {
-				return reinterpret_cast< Class* >((*pointer)->Get().get());
+			if (ObjectHeader* header = ObjectHeader::Get(L, idx)) {
+				if (Class* object = TypeRegistry::Cast< Class >(header->type, header->pointer)) {
+					return object;
+				}
+				return InheritsMetatable(L, idx) ? static_cast< Class* >(header->pointer) : nullptr;
+			}
+			return nullptr;
+
+		} else if (type == VariableType::CData) {
+			TypeId pointerType = nullptr;
+			if (void* pointer = Utils::ToCData(L, idx, pointerType)) {
+				if (Class* object = TypeRegistry::Cast< Class >(pointerType, pointer)) {
+					return object;
+				}
+				return InheritsMetatable(L, idx) ? static_cast< Class* >(pointer) : nullptr;
 			}
-
-		} else if (type == VariableType::LightUserData) {
-			return static_cast< Class* >(lua_touserdata(L, idx));
 		}
 
 		return nullptr;
 	}
 
+	// Classes only related through Engine::GetMetatable(name, parent) keep sharing the derived pointer,
+	// as they did before TypeRegistry. Registering them gives the adjusted one.
+	static bool InheritsMetatable(lua_State* L, const int32_t idx)
+	{
+		static const std::string metatable = Utils::DemangleClassName< Class >();
+		return Utils::InheritsMetatable(L, idx, metatable);
+	}
+
 	static void Push(lua_State* L, Class* value)
 	{
 		if (!value) {
@@ -38,13 +53,22 @@ struct Stack< Class*, std::enable_if_t< std::is_class_v< Class > > >
 			return;
 		}
 
-		lua_pushlightuserdata(L, static_cast< void* >(value));
-
-		const std::string metatable = Utils::DemangleClassName< Class >();
-		luaL_setmetatable(L, metatable.c_str());
+		static const std::string metatable = Utils::DemangleClassName< Class >();
+		Utils::PushCData(L, const_cast< void* >(static_cast< const void* >(value)), metatable, TypeRegistry::GetId< Class >());
 	}
 
-	static bool Is(lua_State* L, const int32_t idx) { return lua_isuserdata(L, idx); }
+	static bool Is(lua_State* L, const int32_t idx)
+	{
+		if (const ObjectHeader* header = ObjectHeader::Get(L, idx)) {
+			return TypeRegistry::Is< Class >(header->type, header->pointer) || InheritsMetatable(L, idx);
+		}
+
+		TypeId pointerType = nullptr;
+		if (void* pointer = Utils::ToCData(L, idx, pointerType)) {
+			return TypeRegistry::Is< Class >(pointerType, pointer) || InheritsMetatable(L, idx);
+		}
+		return false;
+	}
 };
 
 template < class Class >
@@ -52,10 +76,12 @@ struct Stack< std::shared_ptr< Class > >
 {
 	static std::shared_ptr< Class > Get(lua_State* L, const int32_t idx)
 	{
-		const VariableType type = static_cast< VariableType >(lua_type(L, idx));
-		if (type == VariableType::UserData) {
-			if (ObjectOwnership** pointer = static_cast< ObjectOwnership** >(lua_touserdata(L, idx))) {
-				return std::reinterpret_pointer_cast< Class >((*pointer)->Get());
+		if (const ObjectHeader* header = ObjectHeader::Get(L, idx)) {
+			if (Class* object = TypeRegistry::Cast< Class >(header->type, header->pointer)) {
+				return std::shared_ptr< Class >{ header->ownership->Get(), object };
+			}
+			if (Stack< Class* >::InheritsMetatable(L, idx)) {
+				return std::shared_ptr< Class >{ header->ownership->Get(), static_cast< Class* >(header->pointer) };
 			}
 		}
 
@@ -69,9 +95,21 @@ struct Stack< std::shared_ptr< Class > >
 			return;
 		}
 
-		ObjectOwnership* userdata = new ObjectOwnership{ std::reinterpret_pointer_cast< Object >(thing) };
-		ObjectOwnership** pointer = static_cast< ObjectOwnership** >(lua_newuserdata(L, sizeof(ObjectOwnership*)));
-		*pointer = userdata;
+		const void* pointer = static_cast< const void* >(thing.get());
+		if (Utils::IdentityCacheGet(L, pointer)) {
+			const ObjectHeader* header = ObjectHeader::Get(L, -1);
+			if (header && header->type == TypeRegistry::GetId< Class >()) {
+				return;
+			}
+			lua_pop(L, 1);
+		}
+
+		ObjectHeader* header = static_cast< ObjectHeader* >(lua_newuserdata(L, sizeof(ObjectHeader)));
+		*header = ObjectHeader{
+			.ownership = new ObjectOwnership{ std::const_pointer_cast< std::remove_cv_t< Class > >(thing) },
+			.type = TypeRegistry::GetId< Class >(),
+			.pointer = const_cast< void* >(pointer),
+		};
 
 		if constexpr (std::is_base_of_v< Object, Class >) {
 			luaL_setmetatable(L, thing->GetMetatable().data());
@@ -79,14 +117,15 @@ struct Stack< std::shared_ptr< Class > >
 			const std::string metatable = Utils::DemangleClassName< Class >();
 			luaL_setmetatable(L, metatable.data());
 		}
+
+		Utils::CountObject(L, -1, 1);
+		Utils::IdentityCacheSet(L, pointer);
 	}
 
 	inline static bool Is(lua_State* L, const int32_t idx)
 	{
-		const VariableType type = static_cast< VariableType >(lua_type(L, idx));
-		if (type == VariableType::UserData) {
-			ObjectOwnership** pointer = static_cast< ObjectOwnership** >(lua_touserdata(L, idx));
-			return (std::dynamic_pointer_cast< Class >((*pointer)->Get()) != nullptr);
+		if (const ObjectHeader* header = ObjectHeader::Get(L, idx)) {
+			return TypeRegistry::Is< Class >(header->type, header->pointer) || Stack< Class* >::InheritsMetatable(L, idx);
 		}
 
 		return false;
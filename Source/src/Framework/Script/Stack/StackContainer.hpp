@@ -115,7 +115,7 @@ struct Stack< Container, typename std::enable_if_t< TypeTraits::IsMapContainerAs
 	{
 		lua_newtable(L);
 
-		for (const std::pair< KeyType, ValueType >& it : container) {
+		for (const auto& it : container) {
 			Stack< KeyType >::Push(L, it.first);
 			Stack< ValueType >::Push(L, it.second);
 			lua_settable(L, -3);
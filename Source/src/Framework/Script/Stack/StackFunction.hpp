@@ -24,6 +24,7 @@ struct Stack< std::function< int(lua_State*) > >
 			Function** pointer = static_cast< Function** >(lua_touserdata(L, -1));
 			delete *pointer;
 			*pointer = nullptr;
+			Utils::CountFunction(L, -1);
 			return 0;
 		};
 
@@ -35,6 +36,7 @@ struct Stack< std::function< int(lua_State*) > >
 
 		Function** pointer = static_cast< Function** >(lua_newuserdata(L, sizeof(Function)));
 		*pointer = new Function{ function };
+		Utils::CountFunction(L, 1);
 
 		lua_newtable(L);
 		lua_pushcfunction(L, garbaceCollector);
@@ -136,7 +138,7 @@ struct Stack< std::function< Ret(Args...) > >
 				Stack< void >::Push(L, std::forward< Args >(args)...);
 
 				if constexpr (!std::is_same_v< Ret, void >) {
-					if (lua_pcall(L, sizeof...(Args), 1, 0)) {
+					if (Utils::ProtectedCall(L, sizeof...(Args), 1, 0)) {
 						throw std::string("<Script::Stack::Get> ") + lua_tostring(L, -1);
 					}
 
@@ -144,7 +146,7 @@ struct Stack< std::function< Ret(Args...) > >
 					lua_pop(L, 1);
 					return ret;
 				} else {
-					if (lua_pcall(L, sizeof...(Args), 0, 0)) {
+					if (Utils::ProtectedCall(L, sizeof...(Args), 0, 0)) {
 						throw std::string("<Script::Stack::Get> ") + lua_tostring(L, -1);
 					}
 				}
@@ -172,6 +174,7 @@ struct Stack< std::function< Ret(Args...) > >
 			Function** pointer = static_cast< Function** >(lua_touserdata(L, -1));
 			delete *pointer;
 			*pointer = nullptr;
+			Utils::CountFunction(L, -1);
 			return 0;
 		};
 
@@ -201,6 +204,7 @@ struct Stack< std::function< Ret(Args...) > >
 
 		Function** pointer = static_cast< Function** >(lua_newuserdata(L, sizeof(Function)));
 		*pointer = new Function{ function };
+		Utils::CountFunction(L, 1);
 
 		lua_newtable(L);
 		lua_pushcfunction(L, garbaceCollector);
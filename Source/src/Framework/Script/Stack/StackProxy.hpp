@@ -0,0 +1,251 @@
+#ifndef FRAMEWORK_SCRIPT_STACK_STACKPROXY_HPP
+#define FRAMEWORK_SCRIPT_STACK_STACKPROXY_HPP
+
+#include <Framework/Script/Basic.hpp>
+#include <Framework/Script/Stack/StackBasic.hpp>
+#include <Framework/Script/Stack/StackContainer.hpp>
+#include <Framework/Script/TypeTraits.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Script
+{
+
+// Exposes a container to scripts without copying it:
+//   proxy[key], proxy[key] = value, #proxy, for key, value in proxy() do ... end
+// proxy("snapshot") returns a table copy. Sequenced containers are indexed from 1, assigning nil erases map entries.
+template < class Container >
+class Proxy final
+{
+public:
+	explicit Proxy(std::shared_ptr< Container > container)
+		: mContainer(std::move(container)) { }
+
+	// The caller guarantees the container outlives every script reference to the proxy.
+	[[nodiscard]] static auto Borrow(Container& container) -> Proxy
+	{
+		return Proxy{ std::shared_ptr< Container >{ std::shared_ptr< void >{}, &container } };
+	}
+
+	[[nodiscard]] auto Get() const -> Container& { return *mContainer; }
+	[[nodiscard]] auto GetShared() const -> const std::shared_ptr< Container >& { return mContainer; }
+
+private:
+	std::shared_ptr< Container > mContainer = {};
+};
+
+template < class Container >
+struct Stack< Proxy< Container > >
+{
+	static_assert(TypeTraits::IsProxySequenced< Container >::value || TypeTraits::IsProxyMap< Container >::value,
+		"Proxy supports std::vector, std::deque, std::map and std::unordered_map");
+
+	using Pointer = std::shared_ptr< Container >;
+
+	static Proxy< Container > Get(lua_State* L, const int32_t idx)
+	{
+		if (!Is(L, idx)) {
+			return Proxy< Container >{ nullptr };
+		}
+		return Proxy< Container >{ *static_cast< Pointer* >(lua_touserdata(L, idx)) };
+	}
+
+	static void Push(lua_State* L, const Proxy< Container >& proxy)
+	{
+		if (!proxy.GetShared()) {
+			lua_pushnil(L);
+			return;
+		}
+
+		new (lua_newuserdata(L, sizeof(Pointer))) Pointer{ proxy.GetShared() };
+		PushMetatable(L);
+		lua_setmetatable(L, -2);
+	}
+
+	static bool Is(lua_State* L, const int32_t idx)
+	{
+		if (lua_type(L, idx) != LUA_TUSERDATA || !lua_getmetatable(L, idx)) {
+			return false;
+		}
+
+		PushMetatable(L);
+		const bool is = lua_rawequal(L, -1, -2);
+		lua_pop(L, 2);
+		return is;
+	}
+
+private:
+	[[nodiscard]] static auto GetName() -> const std::string&
+	{
+		static const std::string name = "ScriptProxy" + Utils::DemangleClassName< Container >();
+		return name;
+	}
+
+	static auto GetPointer(lua_State* L) -> Pointer&
+	{
+		return *static_cast< Pointer* >(luaL_checkudata(L, 1, GetName().c_str()));
+	}
+
+	// The metamethods and the iterator are reachable from scripts with any first argument.
+	static auto GetContainer(lua_State* L) -> Container&
+	{
+		Pointer& pointer = GetPointer(L);
+		if (!pointer) {
+			luaL_error(L, "<Script::Proxy> Proxy was collected");
+		}
+		return *pointer;
+	}
+
+	static void PushMetatable(lua_State* L)
+	{
+		const std::string& name = GetName();
+		if (!luaL_newmetatable(L, name.c_str())) {
+			return;
+		}
+
+		lua_pushcfunction(L, Collect);
+		lua_setfield(L, -2, "__gc");
+		lua_pushcfunction(L, Index);
+		lua_setfield(L, -2, "__index");
+		lua_pushcfunction(L, NewIndex);
+		lua_setfield(L, -2, "__newindex");
+		lua_pushcfunction(L, Length);
+		lua_setfield(L, -2, "__len");
+		lua_pushcfunction(L, Call);
+		lua_setfield(L, -2, "__call");
+		lua_pushlstring(L, name.data(), name.size());
+		lua_setfield(L, -2, "__name");
+	}
+
+	// Scripts may call __gc themselves, an empty pointer owns nothing and needs no destructor.
+	static auto Collect(lua_State* L) -> int32_t
+	{
+		GetPointer(L).reset();
+		return 0;
+	}
+
+	static auto Length(lua_State* L) -> int32_t
+	{
+		lua_pushinteger(L, static_cast< lua_Integer >(GetContainer(L).size()));
+		return 1;
+	}
+
+	static auto Index(lua_State* L) -> int32_t
+	{
+		const Container& container = GetContainer(L);
+
+		if constexpr (TypeTraits::IsProxySequenced< Container >::value) {
+			const lua_Integer index = lua_tointeger(L, 2);
+			if (lua_type(L, 2) == LUA_TNUMBER && index >= 1 && static_cast< size_t >(index) <= container.size()) {
+				Stack< typename Container::value_type >::Push(L, container[ static_cast< size_t >(index - 1) ]);
+				return 1;
+			}
+		} else {
+			using KeyType = typename Container::key_type;
+			if (Stack< KeyType >::Is(L, 2)) {
+				if (const auto it = container.find(Stack< KeyType >::Get(L, 2)); it != container.end()) {
+					Stack< typename Container::mapped_type >::Push(L, it->second);
+					return 1;
+				}
+			}
+		}
+
+		lua_pushnil(L);
+		return 1;
+	}
+
+	static auto NewIndex(lua_State* L) -> int32_t
+	{
+		Container& container = GetContainer(L);
+
+		if constexpr (TypeTraits::IsProxySequenced< Container >::value) {
+			using ValueType = typename Container::value_type;
+
+			const lua_Integer index = lua_tointeger(L, 2);
+			if (lua_type(L, 2) != LUA_TNUMBER || index < 1 || static_cast< size_t >(index) > container.size() + 1) {
+				return luaL_error(L, "<Script::Proxy> Index out of range");
+			}
+
+			if (static_cast< size_t >(index) == container.size() + 1) {
+				container.push_back(Stack< ValueType >::Get(L, 3));
+			} else {
+				container[ static_cast< size_t >(index - 1) ] = Stack< ValueType >::Get(L, 3);
+			}
+		} else {
+			using KeyType = typename Container::key_type;
+			if (!Stack< KeyType >::Is(L, 2)) {
+				return luaL_error(L, "<Script::Proxy> Invalid key type");
+			}
+
+			if (lua_isnil(L, 3)) {
+				container.erase(Stack< KeyType >::Get(L, 2));
+			} else {
+				container.insert_or_assign(Stack< KeyType >::Get(L, 2), Stack< typename Container::mapped_type >::Get(L, 3));
+			}
+		}
+
+		return 0;
+	}
+
+	// Iterator: (proxy, key) -> next key, value
+	static auto Next(lua_State* L) -> int32_t
+	{
+		const Container& container = GetContainer(L);
+
+		if constexpr (TypeTraits::IsProxySequenced< Container >::value) {
+			const size_t index = lua_isnil(L, 2) ? 0 : static_cast< size_t >(lua_tointeger(L, 2));
+			if (index >= container.size()) {
+				return 0;
+			}
+
+			lua_pushinteger(L, static_cast< lua_Integer >(index + 1));
+			Stack< typename Container::value_type >::Push(L, container[ index ]);
+		} else {
+			using KeyType = typename Container::key_type;
+
+			auto it = container.begin();
+			if (!lua_isnil(L, 2)) {
+				if constexpr (TypeTraits::IsTemplateBase< Container, std::map >::value) {
+					it = container.upper_bound(Stack< KeyType >::Get(L, 2));
+				} else {
+					it = container.find(Stack< KeyType >::Get(L, 2));
+					if (it != container.end()) {
+						++it;
+					}
+				}
+			}
+
+			if (it == container.end()) {
+				return 0;
+			}
+
+			Stack< KeyType >::Push(L, it->first);
+			Stack< typename Container::mapped_type >::Push(L, it->second);
+		}
+
+		return 2;
+	}
+
+	static auto Call(lua_State* L) -> int32_t
+	{
+		if (lua_type(L, 2) == LUA_TSTRING && std::string_view{ lua_tostring(L, 2) } == "snapshot") {
+			Stack< Container >::Push(L, GetContainer(L));
+			return 1;
+		}
+
+		lua_pushcfunction(L, Next);
+		lua_pushvalue(L, 1);
+		lua_pushnil(L);
+		return 3;
+	}
+};
+
+} // namespace Script
+
+#endif
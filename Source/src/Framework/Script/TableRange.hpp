@@ -0,0 +1,204 @@
+#ifndef FRAMEWORK_SCRIPT_TABLERANGE_HPP
+#define FRAMEWORK_SCRIPT_TABLERANGE_HPP
+
+#include <Framework/Script/Basic.hpp>
+#include <Framework/Script/Stack/StackBasic.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <utility>
+
+namespace Script
+{
+
+// Lazy view over the array part of a table (1..#table), values are converted on dereference.
+template < typename Value >
+class ArrayRange final : public std::ranges::view_interface< ArrayRange< Value > >
+{
+public:
+	class Iterator final
+	{
+	public:
+		using value_type = Value;
+		using difference_type = std::ptrdiff_t;
+
+		Iterator() = default;
+		explicit Iterator(lua_State* L, const int32_t table, const int32_t index, const int32_t length)
+			: L(L)
+			, mTable(table)
+			, mIndex(index)
+			, mLength(length) { }
+
+		auto operator*() const -> Value
+		{
+			Utils::StrongRefGet(L, mTable);
+			lua_rawgeti(L, -1, mIndex);
+			Value value = Stack< Value >::Get(L, -1);
+			lua_pop(L, 2);
+			return value;
+		}
+
+		auto operator++() -> Iterator&
+		{
+			++mIndex;
+			return *this;
+		}
+
+		void operator++(int) { ++mIndex; }
+
+		auto operator==(std::default_sentinel_t) const -> bool { return mIndex > mLength; }
+
+	private:
+		lua_State* L = {};
+		int32_t mTable = LUA_REFNIL;
+		int32_t mIndex = 1;
+		int32_t mLength = 0;
+	};
+
+	ArrayRange() = default;
+	explicit ArrayRange(std::shared_ptr< const void > owner, lua_State* L, const int32_t table)
+		: mOwner(std::move(owner))
+		, L(L)
+		, mTable(table) { }
+
+	[[nodiscard]] auto begin() const -> Iterator
+	{
+		if (!L) {
+			return Iterator{};
+		}
+
+		Utils::StrongRefGet(L, mTable);
+		const int32_t length = lua_istable(L, -1) ? static_cast< int32_t >(lua_objlen(L, -1)) : 0;
+		lua_pop(L, 1);
+		return Iterator{ L, mTable, 1, length };
+	}
+
+	[[nodiscard]] auto end() const -> std::default_sentinel_t { return std::default_sentinel; }
+
+private:
+	std::shared_ptr< const void > mOwner = {};
+	lua_State* L = {};
+	int32_t mTable = LUA_REFNIL;
+};
+
+// Lazy view over every key/value pair of a table in lua_next order, the current key lives in a registry slot.
+template < typename Key, typename Value >
+class PairsRange final : public std::ranges::view_interface< PairsRange< Key, Value > >
+{
+public:
+	class Iterator final
+	{
+	public:
+		using value_type = std::pair< Key, Value >;
+		using difference_type = std::ptrdiff_t;
+
+		Iterator() = default;
+		explicit Iterator(lua_State* L, const int32_t table)
+			: L(L)
+			, mTable(table)
+		{
+			lua_pushboolean(L, false);
+			mKey = Utils::StrongRefSet(L);
+			Advance(true);
+		}
+		Iterator(const Iterator&) = delete;
+		Iterator(Iterator&& other) noexcept
+			: L(other.L)
+			, mTable(other.mTable)
+			, mKey(std::exchange(other.mKey, LUA_NOREF)) { }
+		Iterator& operator=(const Iterator&) = delete;
+		Iterator& operator=(Iterator&& other) noexcept
+		{
+			std::swap(L, other.L);
+			std::swap(mTable, other.mTable);
+			std::swap(mKey, other.mKey);
+			return *this;
+		}
+		~Iterator()
+		{
+			if (mKey != LUA_NOREF) {
+				Utils::StrongUnref(L, mKey);
+			}
+		}
+
+		auto operator*() const -> value_type
+		{
+			Utils::StrongRefGet(L, mTable);
+			Utils::StrongRefGet(L, mKey);
+			// Converting the key may change it in place (numbers to strings), the lookup uses a copy.
+			lua_pushvalue(L, -1);
+			lua_rawget(L, -3);
+			Value value = Stack< Value >::Get(L, -1);
+			Key key = Stack< Key >::Get(L, -2);
+			lua_pop(L, 3);
+			return value_type{ std::move(key), std::move(value) };
+		}
+
+		auto operator++() -> Iterator&
+		{
+			Advance(false);
+			return *this;
+		}
+
+		void operator++(int) { Advance(false); }
+
+		auto operator==(std::default_sentinel_t) const -> bool { return mKey == LUA_NOREF; }
+
+	private:
+		void Advance(const bool first)
+		{
+			Utils::StrongRefGet(L, mTable);
+			if (!lua_istable(L, -1)) {
+				lua_pop(L, 1);
+				Finish();
+				return;
+			}
+
+			if (first) {
+				lua_pushnil(L);
+			} else {
+				Utils::StrongRefGet(L, mKey);
+			}
+
+			if (lua_next(L, -2)) {
+				lua_pop(L, 1);
+				lua_rawseti(L, LUA_REGISTRYINDEX, mKey);
+				lua_pop(L, 1);
+			} else {
+				lua_pop(L, 1);
+				Finish();
+			}
+		}
+
+		void Finish()
+		{
+			Utils::StrongUnref(L, mKey);
+			mKey = LUA_NOREF;
+		}
+
+	private:
+		lua_State* L = {};
+		int32_t mTable = LUA_REFNIL;
+		int32_t mKey = LUA_NOREF;
+	};
+
+	PairsRange() = default;
+	explicit PairsRange(std::shared_ptr< const void > owner, lua_State* L, const int32_t table)
+		: mOwner(std::move(owner))
+		, L(L)
+		, mTable(table) { }
+
+	[[nodiscard]] auto begin() const -> Iterator { return L ? Iterator{ L, mTable } : Iterator{}; }
+	[[nodiscard]] auto end() const -> std::default_sentinel_t { return std::default_sentinel; }
+
+private:
+	std::shared_ptr< const void > mOwner = {};
+	lua_State* L = {};
+	int32_t mTable = LUA_REFNIL;
+};
+
+} // namespace Script
+
+#endif
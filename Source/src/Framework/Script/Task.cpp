@@ -0,0 +1,103 @@
+#include <Framework/Script/Task.hpp>
+
+#include <Framework/Script/Engine.hpp>
+
+extern "C" {
+#include <luajit.h>
+}
+
+#include <algorithm>
+#include <utility>
+
+namespace Script
+{
+
+namespace
+{
+
+// Instructions run one by one while the preemption was deferred, in the slice resumed on this thread.
+thread_local uint64_t* DeferredInstructions = nullptr;
+
+} // namespace
+
+Task::Task(const Engine* engine, const std::string& script)
+	: L(engine->State())
+{
+	mThread = lua_newthread(L);
+	mThreadId = Utils::StrongRefSet(L);
+
+	if (luaL_loadstring(mThread, script.c_str())) {
+		std::string error = lua_tostring(mThread, -1);
+		Utils::StrongUnref(L, mThreadId);
+		throw error;
+	}
+
+	luaJIT_setmode(mThread, -1, LUAJIT_MODE_ALLFUNC | LUAJIT_MODE_OFF);
+}
+
+Task::~Task()
+{
+	Utils::StrongUnref(L, mThreadId);
+}
+
+void Task::Preempt(lua_State* L, lua_Debug* debug)
+{
+	if (debug->event != LUA_HOOKCOUNT) {
+		return;
+	}
+
+	// Inside a C call (table.sort comparators, gsub callbacks, callbacks of bindings) the
+	// coroutine can't yield, the hook fires again on every instruction until it can.
+	if (!lua_isyieldable(L)) {
+		lua_sethook(L, Preempt, LUA_MASKCOUNT, 1);
+		if (DeferredInstructions) {
+			++*DeferredInstructions;
+		}
+		return;
+	}
+	lua_yield(L, 0);
+}
+
+auto Task::Resume(const uint32_t budget) -> bool
+{
+	if (IsFinished()) {
+		return false;
+	}
+
+	const lua_Hook hook = lua_gethook(L);
+	const int32_t hookMask = lua_gethookmask(L);
+	const int32_t hookCount = lua_gethookcount(L);
+
+	const int32_t count = static_cast< int32_t >(std::max(budget, uint32_t{ 1 }));
+	uint64_t deferred = 0;
+	uint64_t* const outer = std::exchange(DeferredInstructions, &deferred);
+	lua_sethook(mThread, Preempt, LUA_MASKCOUNT, count);
+	const int32_t status = lua_resume(mThread, 0);
+	lua_sethook(L, hook, hookMask, hookCount);
+	DeferredInstructions = outer;
+
+	++mSlices;
+
+	if (status == LUA_YIELD) {
+		mInstructions += static_cast< uint64_t >(count) + deferred;
+		lua_settop(mThread, 0);
+		return true;
+	}
+
+	if (status != 0) {
+		mStatus = TaskStatus::Failed;
+		std::string error = std::string{ "<Script::Task::Resume> " } + lua_tostring(mThread, -1);
+		lua_settop(mThread, 0);
+		throw error;
+	}
+
+	mStatus = TaskStatus::Finished;
+	if (lua_gettop(mThread) > 0) {
+		lua_xmove(mThread, L, 1);
+		mResult = Reference{ L, -1, true };
+	}
+	lua_settop(mThread, 0);
+	return false;
+}
+
+} // namespace Script
@@ -0,0 +1,85 @@
+#ifndef FRAMEWORK_SCRIPT_TASK_HPP
+#define FRAMEWORK_SCRIPT_TASK_HPP
+
+#include <memory>
+#include <string>
+
+#include <Framework/Script/Reference.hpp>
+
+namespace Script
+{
+
+class Engine;
+
+enum class TaskStatus : uint8_t {
+	Suspended = 0,
+	Finished = 1,
+	Failed = 2,
+};
+
+// Runs a chunk inside a coroutine which is preempted by a count hook once the
+// instruction budget given to Resume() is consumed, so heavy jobs can be spread
+// over many ticks of the host. The chunk is kept out of the JIT because count
+// hooks only fire in interpreted code; functions it calls into are not.
+class Task final
+{
+public:
+	explicit Task(const Engine*, const std::string& script);
+	Task(const Task&) = delete;
+	Task(Task&&) = delete;
+	Task& operator=(const Task&) = delete;
+	Task& operator=(Task&&) = delete;
+	~Task();
+
+	auto Resume(uint32_t budget) -> bool;
+
+	[[nodiscard]] inline auto GetStatus() const -> TaskStatus;
+	[[nodiscard]] inline auto IsFinished() const -> bool;
+	[[nodiscard]] inline auto GetSlices() const -> uint32_t;
+	[[nodiscard]] inline auto GetInstructions() const -> uint64_t;
+	[[nodiscard]] inline auto GetResult() const -> const Reference&;
+
+private:
+	static void Preempt(lua_State*, lua_Debug*);
+
+private:
+	lua_State* L = {};
+	lua_State* mThread = {};
+	int32_t mThreadId = LUA_REFNIL;
+
+	TaskStatus mStatus = TaskStatus::Suspended;
+	uint32_t mSlices = 0;
+	uint64_t mInstructions = 0;
+	Reference mResult = {};
+};
+
+auto Task::GetStatus() const -> TaskStatus
+{
+	return mStatus;
+}
+
+auto Task::IsFinished() const -> bool
+{
+	return (mStatus != TaskStatus::Suspended);
+}
+
+auto Task::GetSlices() const -> uint32_t
+{
+	return mSlices;
+}
+
+auto Task::GetInstructions() const -> uint64_t
+{
+	return mInstructions;
+}
+
+auto Task::GetResult() const -> const Reference&
+{
+	return mResult;
+}
+
+using TaskPtr = std::shared_ptr< Task >;
+
+} // namespace Script
+
+#endif
@@ -0,0 +1,269 @@
+#include <Framework/Script/TraceDiagnostics.hpp>
+
+#include <Framework/Script/Engine.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace Script
+{
+
+namespace
+{
+
+// lj_traceerr.h, indexed by LJ_TRERR_* code.
+constexpr std::string_view ErrorMessages[] = {
+	"error thrown or hook called during recording",
+	"trace too short",
+	"trace too long",
+	"trace too deep",
+	"too many snapshots",
+	"blacklisted",
+	"retry recording",
+	"NYI: bytecode %d",
+	"leaving loop in root trace",
+	"inner loop in root trace",
+	"loop unroll limit reached",
+	"bad argument type",
+	"JIT compilation disabled for function",
+	"call unroll limit reached",
+	"down-recursion, restarting",
+	"NYI: unsupported variant of FastFunc %s",
+	"NYI: return to lower frame",
+	"store with nil or NaN key",
+	"missing metamethod",
+	"looping index lookup",
+	"NYI: mixed sparse/dense table",
+	"symbol not in cache",
+	"NYI: unsupported C type conversion",
+	"NYI: unsupported C function type",
+	"guard would always fail",
+	"too many PHIs",
+	"persistent type instability",
+	"failed to allocate mcode memory",
+	"machine code too long",
+	"hit mcode limit (retrying)",
+	"too many spill slots",
+	"inconsistent register allocation",
+	"NYI: cannot assemble IR instruction %d",
+	"NYI: PHI shuffling too complex",
+	"NYI: register coalescing too complex",
+};
+
+// Opcodes of lj_bc.h.
+constexpr uint32_t UpvalueGetOpcode = 45;
+constexpr uint32_t GlobalGetOpcode = 54;
+constexpr uint32_t FirstCallOpcode = 65;
+constexpr uint32_t LastCallOpcode = 68;
+
+void PushUtil(lua_State* L, const Reference& util, const char* name)
+{
+	Utils::StrongRefGet(L, util.GetId());
+	lua_getfield(L, -1, name);
+	lua_remove(L, -2);
+}
+
+auto GetInstruction(lua_State* L, const Reference& util, const int32_t function, const lua_Integer pc) -> uint32_t
+{
+	PushUtil(L, util, "funcbc");
+	lua_pushvalue(L, function);
+	lua_pushinteger(L, pc);
+	const uint32_t instruction = lua_pcall(L, 2, 1, 0) == 0 ? static_cast< uint32_t >(lua_tointeger(L, -1)) : 0;
+	lua_pop(L, 1);
+	return instruction;
+}
+
+// Registers of an interrupted frame can't be read back from a trace event, the called value
+// is found from the instruction that last loaded the call's base register instead. Only
+// globals and upvalues are followed, anything else pushes nothing.
+auto PushCallee(lua_State* L, const Reference& util, const int32_t function, const lua_Integer pc, const uint32_t base, std::string& name) -> bool
+{
+	for (lua_Integer position = pc - 1; position > 0; --position) {
+		const uint32_t instruction = GetInstruction(L, util, function, position);
+		if (((instruction >> 8) & 0xff) != base) {
+			continue;
+		}
+
+		const uint32_t opcode = instruction & 0xff;
+		const int32_t operand = static_cast< int32_t >(instruction >> 16);
+		if (opcode == GlobalGetOpcode) {
+			PushUtil(L, util, "funck");
+			lua_pushvalue(L, function);
+			lua_pushinteger(L, -operand - 1);
+			if (lua_pcall(L, 2, 1, 0) != 0 || !lua_isstring(L, -1)) {
+				lua_pop(L, 1);
+				return false;
+			}
+			name = lua_tostring(L, -1);
+			lua_getfenv(L, function);
+			lua_insert(L, -2);
+			lua_rawget(L, -2);
+			lua_remove(L, -2);
+			return true;
+		}
+		if (opcode == UpvalueGetOpcode) {
+			const char* upvalue = lua_getupvalue(L, function, operand + 1);
+			name = upvalue ? upvalue : "";
+			return upvalue != nullptr;
+		}
+		return false;
+	}
+	return false;
+}
+
+} // namespace
+
+TraceDiagnostics::TraceDiagnostics(const Engine* engine)
+	: mJit(engine->Jit())
+{
+	mHandler = mJit->AddTraceHandler([ this ](lua_State* L) { OnTrace(L); });
+}
+
+TraceDiagnostics::~TraceDiagnostics()
+{
+	mJit->RemoveTraceHandler(mHandler);
+}
+
+auto TraceDiagnostics::GetTopReasons(const size_t count) const -> std::vector< TraceAbortReason >
+{
+	std::unordered_map< std::string, uint64_t > reasons = {};
+	for (const auto& [ key, site ] : mSites) {
+		reasons[ site.reason ] += site.count;
+	}
+
+	std::vector< TraceAbortReason > result = {};
+	result.reserve(reasons.size());
+	for (auto& [ reason, total ] : reasons) {
+		result.push_back(TraceAbortReason{ .reason = reason, .count = total });
+	}
+
+	std::sort(result.begin(), result.end(), [](const TraceAbortReason& left, const TraceAbortReason& right) {
+		return left.count != right.count ? left.count > right.count : left.reason < right.reason;
+	});
+	result.resize(std::min(count, result.size()));
+	return result;
+}
+
+auto TraceDiagnostics::GetTopSites(const size_t count) const -> std::vector< TraceAbortSite >
+{
+	std::vector< TraceAbortSite > result = {};
+	result.reserve(mSites.size());
+	for (const auto& [ key, site ] : mSites) {
+		result.push_back(site);
+	}
+
+	std::stable_sort(result.begin(), result.end(), [](const TraceAbortSite& left, const TraceAbortSite& right) {
+		return left.count > right.count;
+	});
+	result.resize(std::min(count, result.size()));
+	return result;
+}
+
+void TraceDiagnostics::Reset()
+{
+	mAborts = 0;
+	mBindingAborts = 0;
+	mSites.clear();
+}
+
+auto TraceDiagnostics::GetErrorMessage(const int32_t code) -> std::string_view
+{
+	if (code < 0 || static_cast< size_t >(code) >= std::size(ErrorMessages)) {
+		return {};
+	}
+	return ErrorMessages[ code ];
+}
+
+void TraceDiagnostics::OnTrace(lua_State* L)
+{
+	const char* what = lua_tostring(L, 1);
+	if (!what || std::strcmp(what, "abort") != 0) {
+		return;
+	}
+
+	TraceAbortSite site = {
+		.location = "?",
+		.reason = Describe(L),
+	};
+	Inspect(L, site);
+
+	mAborts++;
+	mBindingAborts += site.binding ? 1 : 0;
+
+	auto [ it, inserted ] = mSites.try_emplace(std::make_pair(site.location, site.reason), std::move(site));
+	it->second.count++;
+}
+
+// ("abort", tr, func, pc, error, info): error is a trace error code or a runtime error message,
+// info fills the %d or %s of the code's message.
+auto TraceDiagnostics::Describe(lua_State* L) const -> std::string
+{
+	if (lua_type(L, 5) != LUA_TNUMBER) {
+		const char* message = lua_tostring(L, 5);
+		return message ? message : "?";
+	}
+
+	const int32_t code = static_cast< int32_t >(lua_tointeger(L, 5));
+	std::string message{ GetErrorMessage(code) };
+	if (message.empty()) {
+		return "trace error " + std::to_string(code);
+	}
+
+	const size_t format = message.find('%');
+	if (format != std::string::npos && format + 1 < message.size()) {
+		std::string info = "?";
+		if (lua_type(L, 6) == LUA_TNUMBER || lua_type(L, 6) == LUA_TSTRING) {
+			info = lua_tostring(L, 6);
+		} else if (lua_type(L, 6) == LUA_TFUNCTION) {
+			info = "builtin";
+		}
+		message.replace(format, 2, info);
+	}
+	return message;
+}
+
+void TraceDiagnostics::Inspect(lua_State* L, TraceAbortSite& site) const
+{
+	if (!lua_isfunction(L, 3) || lua_iscfunction(L, 3) || lua_type(L, 4) != LUA_TNUMBER) {
+		return;
+	}
+	const Reference& util = mJit->GetUtil();
+	const int32_t top = lua_gettop(L);
+
+	PushUtil(L, util, "funcinfo");
+	lua_pushvalue(L, 3);
+	lua_pushvalue(L, 4);
+	if (lua_pcall(L, 2, 1, 0) == 0 && lua_istable(L, -1)) {
+		lua_getfield(L, -1, "loc");
+		if (lua_isstring(L, -1)) {
+			site.location = lua_tostring(L, -1);
+		}
+	}
+	lua_settop(L, top);
+
+	const uint32_t instruction = GetInstruction(L, util, 3, lua_tointeger(L, 4));
+	const uint32_t opcode = instruction & 0xff;
+	std::string callee = {};
+	if (opcode < FirstCallOpcode || opcode > LastCallOpcode || !PushCallee(L, util, 3, lua_tointeger(L, 4), (instruction >> 8) & 0xff, callee)) {
+		return;
+	}
+
+	if (lua_iscfunction(L, -1)) {
+		PushUtil(L, util, "funcinfo");
+		lua_pushvalue(L, -2);
+		if (lua_pcall(L, 1, 1, 0) == 0 && lua_istable(L, -1)) {
+			lua_getfield(L, -1, "ffid");
+			site.binding = lua_tointeger(L, -1) == 0;
+		}
+	} else if ((lua_isuserdata(L, -1) || lua_istable(L, -1)) && lua_getmetatable(L, -1)) {
+		lua_getfield(L, -1, "__call");
+		site.binding = !lua_isnil(L, -1);
+	}
+	if (site.binding) {
+		site.callee = std::move(callee);
+	}
+	lua_settop(L, top);
+}
+
+} // namespace Script
@@ -0,0 +1,85 @@
+#ifndef FRAMEWORK_SCRIPT_TRACEDIAGNOSTICS_HPP
+#define FRAMEWORK_SCRIPT_TRACEDIAGNOSTICS_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <Framework/Script/JitControl.hpp>
+
+namespace Script
+{
+
+struct TraceAbortReason
+{
+	std::string reason = {};
+	uint64_t count = 0;
+};
+
+struct TraceAbortSite
+{
+	// chunk:line of the instruction the trace aborted at.
+	std::string location = {};
+	std::string reason = {};
+	// Set when the aborting instruction calls a C function that is not a LuaJIT builtin,
+	// or a userdata or table through __call, loaded from a global or an upvalue.
+	bool binding = false;
+	// Name of the global or upvalue the binding was called through.
+	std::string callee = {};
+	uint64_t count = 0;
+};
+
+// Collects trace aborts of one engine while it exists, grouped by location and reason.
+class TraceDiagnostics final
+{
+public:
+	explicit TraceDiagnostics(const Engine*);
+	TraceDiagnostics(const TraceDiagnostics&) = delete;
+	TraceDiagnostics(TraceDiagnostics&&) = delete;
+	TraceDiagnostics& operator=(const TraceDiagnostics&) = delete;
+	TraceDiagnostics& operator=(TraceDiagnostics&&) = delete;
+	~TraceDiagnostics();
+
+	[[nodiscard]] inline auto GetAborts() const -> uint64_t;
+	[[nodiscard]] inline auto GetBindingAborts() const -> uint64_t;
+	// Most frequent first.
+	[[nodiscard]] auto GetTopReasons(size_t count) const -> std::vector< TraceAbortReason >;
+	[[nodiscard]] auto GetTopSites(size_t count) const -> std::vector< TraceAbortSite >;
+	void Reset();
+
+	// Message of a LuaJIT trace error code, empty for unknown codes.
+	[[nodiscard]] static auto GetErrorMessage(int32_t code) -> std::string_view;
+
+private:
+	void OnTrace(lua_State*);
+	[[nodiscard]] auto Describe(lua_State*) const -> std::string;
+	void Inspect(lua_State*, TraceAbortSite& site) const;
+
+private:
+	JitControlPtr mJit = {};
+	uint32_t mHandler = 0;
+
+	uint64_t mAborts = 0;
+	uint64_t mBindingAborts = 0;
+	std::map< std::pair< std::string, std::string >, TraceAbortSite > mSites = {};
+};
+
+using TraceDiagnosticsPtr = std::shared_ptr< TraceDiagnostics >;
+
+auto TraceDiagnostics::GetAborts() const -> uint64_t
+{
+	return mAborts;
+}
+
+auto TraceDiagnostics::GetBindingAborts() const -> uint64_t
+{
+	return mBindingAborts;
+}
+
+} // namespace Script
+
+#endif
@@ -0,0 +1,63 @@
+#include <Framework/Script/TypeRegistry.hpp>
+
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace Script
+{
+
+namespace
+{
+
+struct RelationKey
+{
+	TypeId derived = nullptr;
+	TypeId base = nullptr;
+
+	auto operator==(const RelationKey&) const -> bool = default;
+};
+
+struct RelationKeyHash
+{
+	auto operator()(const RelationKey& key) const -> size_t
+	{
+		const size_t derived = std::hash< TypeId >{}(key.derived);
+		return derived ^ (std::hash< TypeId >{}(key.base) + 0x9e3779b97f4a7c15 + (derived << 6) + (derived >> 2));
+	}
+};
+
+// Relationships are compile-time facts shared by every engine. They may be registered while engines are
+// built or used on other threads, e.g. by EngineFactory::AddType next to a running pool.
+struct Relations
+{
+	std::shared_mutex mutex = {};
+	std::unordered_map< RelationKey, TypeRegistry::Relation, RelationKeyHash > map = {};
+};
+
+auto GetRelations() -> Relations&
+{
+	static Relations relations = {};
+	return relations;
+}
+
+} // namespace
+
+void TypeRegistry::Insert(const TypeId derived, const TypeId base, const Relation relation)
+{
+	Relations& relations = GetRelations();
+	const std::unique_lock lock{ relations.mutex };
+	// Registered relations never change, so pointers returned by Find stay valid without the lock.
+	relations.map.emplace(RelationKey{ derived, base }, relation);
+}
+
+auto TypeRegistry::Find(const TypeId derived, const TypeId base) -> const Relation*
+{
+	Relations& relations = GetRelations();
+	const std::shared_lock lock{ relations.mutex };
+	const auto it = relations.map.find(RelationKey{ derived, base });
+	return it != relations.map.end() ? &it->second : nullptr;
+}
+
+} // namespace Script
@@ -0,0 +1,128 @@
+#ifndef FRAMEWORK_SCRIPT_TYPEREGISTRY_HPP
+#define FRAMEWORK_SCRIPT_TYPEREGISTRY_HPP
+
+#include <Framework/Script/Object.hpp>
+
+#include <cstddef>
+#include <type_traits>
+
+namespace Script
+{
+
+struct TypeInfo
+{
+	Object* (*toObject)(void*) = nullptr;
+};
+
+using TypeId = const TypeInfo*;
+
+class TypeRegistry final
+{
+public:
+	struct Relation
+	{
+		std::ptrdiff_t offset = 0;
+		void* (*cast)(void*) = nullptr;
+
+		[[nodiscard]] inline auto Apply(void* pointer) const -> void*;
+	};
+
+	template < class Class >
+	[[nodiscard]] inline static auto GetId() -> TypeId;
+
+	// Registers Derived -> Base upcasts, every ancestor reachable from scripts should be listed.
+	template < class Derived, class... Bases >
+	static void Register();
+
+	// Returns nullptr when the types are unrelated or the relationship is not registered.
+	template < class Class >
+	[[nodiscard]] static auto Cast(TypeId type, void* pointer) -> Class*;
+
+	template < class Class >
+	[[nodiscard]] static auto Is(TypeId type, void* pointer) -> bool;
+
+private:
+	template < class Class >
+	inline static const TypeInfo Info = {
+		.toObject = [](void* pointer) -> Object* {
+			if constexpr (std::is_base_of_v< Object, Class >) {
+				return static_cast< Object* >(static_cast< Class* >(pointer));
+			} else {
+				return nullptr;
+			}
+		},
+	};
+
+	template < class Derived, class Base >
+	static void RegisterBase();
+
+	static void Insert(TypeId derived, TypeId base, Relation relation);
+	[[nodiscard]] static auto Find(TypeId derived, TypeId base) -> const Relation*;
+};
+
+auto TypeRegistry::Relation::Apply(void* pointer) const -> void*
+{
+	return cast ? cast(pointer) : static_cast< std::byte* >(pointer) + offset;
+}
+
+template < class Class >
+auto TypeRegistry::GetId() -> TypeId
+{
+	return &Info< std::remove_cv_t< Class > >;
+}
+
+template < class Derived, class... Bases >
+void TypeRegistry::Register()
+{
+	(RegisterBase< Derived, Bases >(), ...);
+}
+
+template < class Derived, class Base >
+void TypeRegistry::RegisterBase()
+{
+	static_assert(std::is_base_of_v< Base, Derived >, "Base is not a base class of Derived");
+
+	Relation relation = {};
+	if constexpr (requires(Base* base) { static_cast< Derived* >(base); }) {
+		alignas(Derived) static std::byte storage[ sizeof(Derived) ] = {};
+		Derived* derived = reinterpret_cast< Derived* >(storage);
+		relation.offset = reinterpret_cast< std::byte* >(static_cast< Base* >(derived)) - storage;
+	} else {
+		// Virtual bases are located through the object itself.
+		relation.cast = [](void* pointer) -> void* {
+			return static_cast< Base* >(static_cast< Derived* >(pointer));
+		};
+	}
+
+	Insert(GetId< Derived >(), GetId< Base >(), relation);
+}
+
+template < class Class >
+auto TypeRegistry::Cast(const TypeId type, void* pointer) -> Class*
+{
+	if (type == GetId< Class >()) {
+		return static_cast< Class* >(pointer);
+	}
+
+	if (const Relation* relation = Find(type, GetId< Class >())) {
+		return static_cast< Class* >(relation->Apply(pointer));
+	}
+
+	if constexpr (std::is_base_of_v< Object, Class > && std::is_polymorphic_v< Class >) {
+		if (Object* object = type->toObject(pointer)) {
+			return dynamic_cast< Class* >(object);
+		}
+	}
+
+	return nullptr;
+}
+
+template < class Class >
+auto TypeRegistry::Is(const TypeId type, void* pointer) -> bool
+{
+	return Cast< Class >(type, pointer) != nullptr;
+}
+
+} // namespace Script
+
+#endif
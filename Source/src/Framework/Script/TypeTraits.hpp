@@ -46,6 +46,16 @@ using IsMapContainerAssociatived = std::disjunction<
 	TypeTraits::IsTemplateBase< Container, std::unordered_map >,
 	TypeTraits::IsTemplateBase< Container, std::unordered_multimap > >;
 
+template < class Container >
+using IsProxySequenced = std::disjunction<
+	TypeTraits::IsTemplateBase< Container, std::deque >,
+	TypeTraits::IsTemplateBase< Container, std::vector > >;
+
+template < class Container >
+using IsProxyMap = std::disjunction<
+	TypeTraits::IsTemplateBase< Container, std::map >,
+	TypeTraits::IsTemplateBase< Container, std::unordered_map > >;
+
 template < class Type >
 using IsInteger = std::disjunction<
 	std::is_same< Type, uint8_t >,
@@ -16,6 +16,7 @@ enum class VariableType : uint8_t {
 	Function = 6,
 	UserData = 7,
 	Thread = 8,
+	CData = 10,
 };
 
 } // namespace Script
@@ -0,0 +1,488 @@
+#include <Framework/Script/Engine.hpp>
+
+#include <Framework/Script/EngineFactory.hpp>
+#include <Framework/Script/EventBus.hpp>
+#include <Framework/Script/Metatable.hpp>
+#include <Framework/Script/Sandbox.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+class Entity
+{
+public:
+	explicit Entity(const int32_t health)
+		: mHealth(health) { }
+
+	[[nodiscard]] auto GetHealth() const -> int32_t { return mHealth; }
+	void SetHealth(const int32_t health) { mHealth = health; }
+
+	int32_t health = 0;
+
+private:
+	int32_t mHealth = 0;
+};
+
+using EntityPtr = std::shared_ptr< Entity >;
+
+struct Payload
+{
+	int32_t id = 0;
+	double x = 0.0;
+	double y = 0.0;
+	std::string name = {};
+};
+
+auto StaticFunction(const int32_t value) -> int32_t
+{
+	return value + 1;
+}
+
+void RegisterEntity(const Script::Engine& script)
+{
+	script.GetMetatable(Script::Utils::DemangleClassName< Entity >())
+		->RegisterReferenceDestructor(&script)
+		->SetField("GetHealth", &Entity::GetHealth)
+		->SetField("SetHealth", &Entity::SetHealth)
+		->SetProperty("health", &Entity::health);
+}
+
+template < typename Type >
+void StackPushGet(benchmark::State& state, const Type& value)
+{
+	Script::Engine script;
+	lua_State* L = script.State();
+
+	for (auto _ : state) {
+		Script::Stack< Type >::Push(L, value);
+		benchmark::DoNotOptimize(Script::Stack< Type >::Get(L, -1));
+		lua_pop(L, 1);
+	}
+}
+
+template < typename Type >
+void StackPush(benchmark::State& state, const Script::Engine& script, const Type& value)
+{
+	lua_State* L = script.State();
+
+	for (auto _ : state) {
+		Script::Stack< Type >::Push(L, value);
+		lua_pop(L, 1);
+	}
+}
+
+} // namespace
+
+SCRIPT_FIELDS(Payload, id, x, y, name);
+
+////////////////      Stack     ////////////////
+
+static void Stack_Integer(benchmark::State& state)
+{
+	StackPushGet(state, int32_t{ 123 });
+}
+BENCHMARK(Stack_Integer);
+
+static void Stack_Double(benchmark::State& state)
+{
+	StackPushGet(state, double{ 3.14 });
+}
+BENCHMARK(Stack_Double);
+
+static void Stack_Boolean(benchmark::State& state)
+{
+	StackPushGet(state, true);
+}
+BENCHMARK(Stack_Boolean);
+
+static void Stack_String(benchmark::State& state)
+{
+	StackPushGet(state, std::string{ "FooBar" });
+}
+BENCHMARK(Stack_String);
+
+static void Stack_StringLong(benchmark::State& state)
+{
+	StackPushGet(state, std::string(256, 'x'));
+}
+BENCHMARK(Stack_StringLong);
+
+static void Stack_Optional(benchmark::State& state)
+{
+	StackPushGet(state, std::optional< int32_t >{ 123 });
+}
+BENCHMARK(Stack_Optional);
+
+static void Stack_Variant(benchmark::State& state)
+{
+	using VariantType = std::variant< std::monostate, bool, int32_t, std::string >;
+	StackPushGet(state, VariantType{ std::string{ "FooBar" } });
+}
+BENCHMARK(Stack_Variant);
+
+static void Stack_Pair(benchmark::State& state)
+{
+	StackPushGet(state, std::pair< int32_t, std::string >{ 123, "FooBar" });
+}
+BENCHMARK(Stack_Pair);
+
+static void Stack_Vector(benchmark::State& state)
+{
+	StackPushGet(state, std::vector< int32_t >(static_cast< size_t >(state.range(0)), 123));
+}
+BENCHMARK(Stack_Vector)->Arg(8)->Arg(512);
+
+static void Stack_Set(benchmark::State& state)
+{
+	std::set< int32_t > value = {};
+	for (int32_t i = 0; i < state.range(0); ++i) {
+		value.insert(i);
+	}
+	StackPushGet(state, value);
+}
+BENCHMARK(Stack_Set)->Arg(8)->Arg(512);
+
+static void Stack_Map(benchmark::State& state)
+{
+	std::map< std::string, int32_t > value = {};
+	for (int32_t i = 0; i < state.range(0); ++i) {
+		value.emplace(std::to_string(i), i);
+	}
+	StackPushGet(state, value);
+}
+BENCHMARK(Stack_Map)->Arg(8)->Arg(512);
+
+static void Stack_Aggregate(benchmark::State& state)
+{
+	StackPushGet(state, Payload{ .id = 1, .x = 2.0, .y = 3.0, .name = "FooBar" });
+}
+BENCHMARK(Stack_Aggregate);
+
+static void Stack_SharedObject(benchmark::State& state)
+{
+	Script::Engine script;
+	RegisterEntity(script);
+
+	lua_State* L = script.State();
+	const EntityPtr entity{ new Entity{ 100 } };
+
+	for (auto _ : state) {
+		Script::Stack< EntityPtr >::Push(L, entity);
+		benchmark::DoNotOptimize(Script::Stack< EntityPtr >::Get(L, -1));
+		lua_pop(L, 1);
+	}
+
+	script.CollectGarbage();
+}
+BENCHMARK(Stack_SharedObject);
+
+static void Stack_RawObject(benchmark::State& state)
+{
+	Script::Engine script;
+	RegisterEntity(script);
+
+	Entity entity{ 100 };
+	StackPush(state, script, &entity);
+}
+BENCHMARK(Stack_RawObject);
+
+// Get of an object pushed once, userdata header against cdata ctype.
+template < typename Type >
+void StackGet(benchmark::State& state, const Script::Engine& script, const Type& value)
+{
+	lua_State* L = script.State();
+	Script::Stack< Type >::Push(L, value);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(Script::Stack< Type >::Get(L, -1));
+	}
+
+	lua_pop(L, 1);
+}
+
+static void Stack_SharedObjectGet(benchmark::State& state)
+{
+	Script::Engine script;
+	RegisterEntity(script);
+
+	StackGet(state, script, EntityPtr{ new Entity{ 100 } });
+	script.CollectGarbage();
+}
+BENCHMARK(Stack_SharedObjectGet);
+
+static void Stack_RawObjectGet(benchmark::State& state)
+{
+	Script::Engine script;
+	RegisterEntity(script);
+
+	Entity entity{ 100 };
+	StackGet(state, script, &entity);
+}
+BENCHMARK(Stack_RawObjectGet);
+
+static void Stack_Reference(benchmark::State& state)
+{
+	Script::Engine script;
+	lua_State* L = script.State();
+	const Script::Reference reference = script.Execute(R"(return { 1, 2, 3 })");
+
+	for (auto _ : state) {
+		Script::Stack< Script::Reference >::Push(L, reference);
+		benchmark::DoNotOptimize(Script::Stack< Script::Reference >::Get(L, -1));
+		lua_pop(L, 1);
+	}
+}
+BENCHMARK(Stack_Reference);
+
+static void Stack_Function(benchmark::State& state)
+{
+	StackPushGet(state, std::function< int32_t(int32_t) >{ [](const int32_t value) { return value + 1; } });
+}
+BENCHMARK(Stack_Function);
+
+////////////////      Lua -> C++     ////////////////
+
+static void Call_StaticFunction(benchmark::State& state)
+{
+	Script::Engine script;
+	script.SetGlobal("StaticFunction", StaticFunction);
+	const Script::Reference loop = script.Execute(R"(
+		return function(count)
+			local Variable = 0;
+			for i = 1, count do
+				Variable = StaticFunction(Variable);
+			end
+			return Variable;
+		end
+	)");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(loop(state.range(0)));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Call_StaticFunction)->Arg(1000);
+
+static void Call_WrapperFunction(benchmark::State& state)
+{
+	Script::Engine script;
+	script.SetGlobal("WrapperFunction", std::function{ [](const int32_t value) {
+		return value + 1;
+	} });
+	const Script::Reference loop = script.Execute(R"(
+		return function(count)
+			local Variable = 0;
+			for i = 1, count do
+				Variable = WrapperFunction(Variable);
+			end
+			return Variable;
+		end
+	)");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(loop(state.range(0)));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Call_WrapperFunction)->Arg(1000);
+
+static void Call_MemberFunction(benchmark::State& state)
+{
+	Script::Engine script;
+	RegisterEntity(script);
+	script.SetGlobal("Variable", EntityPtr{ new Entity{ 100 } });
+	const Script::Reference loop = script.Execute(R"(
+		return function(count)
+			for i = 1, count do
+				Variable:SetHealth(Variable:GetHealth() + 1);
+			end
+		end
+	)");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(loop(state.range(0)));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+
+	script.RemoveGlobal("Variable");
+	script.CollectGarbage();
+}
+BENCHMARK(Call_MemberFunction)->Arg(1000);
+
+static void Call_RawMemberFunction(benchmark::State& state)
+{
+	Script::Engine script;
+	RegisterEntity(script);
+
+	Entity entity{ 100 };
+	script.SetGlobal("Variable", &entity);
+	const Script::Reference loop = script.Execute(R"(
+		return function(count)
+			for i = 1, count do
+				Variable:SetHealth(Variable:GetHealth() + 1);
+			end
+		end
+	)");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(loop(state.range(0)));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+
+	script.RemoveGlobal("Variable");
+}
+BENCHMARK(Call_RawMemberFunction)->Arg(1000);
+
+static void Call_Property(benchmark::State& state)
+{
+	Script::Engine script;
+	RegisterEntity(script);
+	script.SetGlobal("Variable", EntityPtr{ new Entity{ 100 } });
+	const Script::Reference loop = script.Execute(R"(
+		return function(count)
+			for i = 1, count do
+				Variable.health = Variable.health + 1;
+			end
+		end
+	)");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(loop(state.range(0)));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+
+	script.RemoveGlobal("Variable");
+	script.CollectGarbage();
+}
+BENCHMARK(Call_Property)->Arg(1000);
+
+////////////////      C++ -> Lua     ////////////////
+
+static void Reference_Call(benchmark::State& state)
+{
+	Script::Engine script;
+	const Script::Reference function = script.Execute(R"(return function(value) return value + 1; end)");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(function(123));
+	}
+}
+BENCHMARK(Reference_Call);
+
+static void Reference_CallAndGet(benchmark::State& state)
+{
+	Script::Engine script;
+	const Script::Reference function = script.Execute(R"(return function(value) return value + 1; end)");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(function(123).Get< int32_t >());
+	}
+}
+BENCHMARK(Reference_CallAndGet);
+
+static void Reference_CallBatch(benchmark::State& state)
+{
+	Script::Engine script;
+	const Script::Reference function = script.Execute(R"(return function(value) return value + 1; end)");
+	const std::vector< int32_t > arguments(static_cast< size_t >(state.range(0)), 123);
+	std::vector< int32_t > results(arguments.size());
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(function.CallBatch(arguments, results));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Reference_CallBatch)->Arg(1000);
+
+static void EventBus_Emit(benchmark::State& state)
+{
+	Script::Engine script;
+	const Script::EventBusPtr bus = script.GetEventBus();
+	for (int64_t i = 0; i < state.range(0); ++i) {
+		static_cast< void >(script.ExecuteRaw(R"(EventBus.On("Tick", function(value) return value + 1; end))"));
+	}
+	const Script::EventBus::EventId tick = bus->GetEventId("Tick");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(bus->Emit(tick, 123));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(EventBus_Emit)->Arg(8);
+
+static void Reference_GetGlobal(benchmark::State& state)
+{
+	Script::Engine script;
+	script.SetGlobal("Variable", int32_t{ 123 });
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(script[ "Variable" ].Get< int32_t >());
+	}
+}
+BENCHMARK(Reference_GetGlobal);
+
+static void Reference_SetField(benchmark::State& state)
+{
+	Script::Engine script;
+	Script::Reference global = script.GetGlobal();
+
+	for (auto _ : state) {
+		global.SetField(std::string{ "Variable" }, int32_t{ 123 });
+	}
+}
+BENCHMARK(Reference_SetField);
+
+////////////////      Engine     ////////////////
+
+static void Engine_Construct(benchmark::State& state)
+{
+	for (auto _ : state) {
+		Script::Engine script;
+		benchmark::DoNotOptimize(script.State());
+	}
+}
+BENCHMARK(Engine_Construct);
+
+static void Engine_ConstructLazy(benchmark::State& state)
+{
+	for (auto _ : state) {
+		Script::Engine script{ Script::EngineOptions{ .lazyLibraries = true } };
+		benchmark::DoNotOptimize(script.State());
+	}
+}
+BENCHMARK(Engine_ConstructLazy);
+
+static void EngineFactory_Create(benchmark::State& state)
+{
+	Script::EngineFactory factory;
+	factory.AddChunk("Init", "function Increment(value) return value + 1; end");
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(factory.Create());
+	}
+}
+BENCHMARK(EngineFactory_Create);
+
+static void Engine_ExecuteRaw(benchmark::State& state)
+{
+	Script::Engine script;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(script.ExecuteRaw("local Variable = 1 + 2;"));
+	}
+}
+BENCHMARK(Engine_ExecuteRaw);
+
+static void Sandbox_Execute(benchmark::State& state)
+{
+	Script::Engine script;
+	const Script::SandboxPtr sandbox = script.GetSandbox("Sandbox");
+	sandbox->SetField("Variable", 0);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(sandbox->Execute("Variable = Variable + 1;"));
+	}
+}
+BENCHMARK(Sandbox_Execute);
@@ -0,0 +1,127 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+std::atomic< size_t > Allocations = 0;
+
+auto CountedAllocate(const std::size_t size) -> void*
+{
+	Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size ? size : 1)) {
+		return pointer;
+	}
+	throw std::bad_alloc{};
+}
+
+auto CountedAllocate(const std::size_t size, const std::align_val_t alignment) -> void*
+{
+	Allocations.fetch_add(1, std::memory_order_relaxed);
+	const std::size_t align = static_cast< std::size_t >(alignment);
+	if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+		return pointer;
+	}
+	throw std::bad_alloc{};
+}
+
+} // namespace
+
+auto operator new(const std::size_t size) -> void*
+{
+	return CountedAllocate(size);
+}
+
+auto operator new[](const std::size_t size) -> void*
+{
+	return CountedAllocate(size);
+}
+
+auto operator new(const std::size_t size, const std::align_val_t alignment) -> void*
+{
+	return CountedAllocate(size, alignment);
+}
+
+auto operator new[](const std::size_t size, const std::align_val_t alignment) -> void*
+{
+	return CountedAllocate(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+	std::free(pointer);
+}
+
+AllocationCounter::AllocationCounter(lua_State* L)
+	: L(L)
+	, mAllocations(Allocations.load(std::memory_order_relaxed))
+{
+	if (L) {
+		mAllocator = lua_getallocf(L, &mAllocatorData);
+		lua_setallocf(L, Allocate, this);
+	}
+}
+
+AllocationCounter::~AllocationCounter()
+{
+	if (L) {
+		lua_setallocf(L, mAllocator, mAllocatorData);
+	}
+}
+
+auto AllocationCounter::GetAllocations() const -> size_t
+{
+	return Allocations.load(std::memory_order_relaxed) - mAllocations;
+}
+
+auto AllocationCounter::GetLuaAllocations() const -> size_t
+{
+	return mLuaAllocations;
+}
+
+auto AllocationCounter::Allocate(void* ud, void* pointer, const size_t oldSize, const size_t newSize) -> void*
+{
+	AllocationCounter* counter = static_cast< AllocationCounter* >(ud);
+	if (newSize > (pointer ? oldSize : 0)) {
+		++counter->mLuaAllocations;
+	}
+	return counter->mAllocator(counter->mAllocatorData, pointer, oldSize, newSize);
+}
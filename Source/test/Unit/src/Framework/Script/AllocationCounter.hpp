@@ -0,0 +1,36 @@
+#ifndef TEST_UNIT_FRAMEWORK_SCRIPT_ALLOCATIONCOUNTER_HPP
+#define TEST_UNIT_FRAMEWORK_SCRIPT_ALLOCATIONCOUNTER_HPP
+
+extern "C" {
+#include <lua.h>
+}
+
+#include <cstddef>
+
+// Counts global operator new calls and, when given a state, calls of its Lua
+// allocator which grow or create a block, for as long as the counter lives.
+class AllocationCounter final
+{
+public:
+	explicit AllocationCounter(lua_State* L = nullptr);
+	AllocationCounter(const AllocationCounter&) = delete;
+	AllocationCounter(AllocationCounter&&) = delete;
+	AllocationCounter& operator=(const AllocationCounter&) = delete;
+	AllocationCounter& operator=(AllocationCounter&&) = delete;
+	~AllocationCounter();
+
+	[[nodiscard]] auto GetAllocations() const -> size_t;
+	[[nodiscard]] auto GetLuaAllocations() const -> size_t;
+
+private:
+	static auto Allocate(void* ud, void* pointer, size_t oldSize, size_t newSize) -> void*;
+
+private:
+	lua_State* L = {};
+	lua_Alloc mAllocator = {};
+	void* mAllocatorData = {};
+	size_t mAllocations = 0;
+	size_t mLuaAllocations = 0;
+};
+
+#endif
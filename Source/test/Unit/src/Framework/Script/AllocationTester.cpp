@@ -0,0 +1,156 @@
+#include "AllocationCounter.hpp"
+
+#include <Framework/Script/Engine.hpp>
+
+#include <algorithm>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace testing;
+
+class UnitScript_Allocation : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		script.SetGlobal("BoundFunction", std::function{ [](const int32_t value) {
+			return value + 1;
+		} });
+
+		ASSERT_TRUE(script.ExecuteRaw(R"(
+			Variable = 123;
+			function Callback(value)
+				return value + 1;
+			end
+			function CallBoundFunction()
+				local Variable = 0;
+				for i = 1, 10 do
+					Variable = BoundFunction(Variable);
+				end
+				return Variable;
+			end
+		)"));
+	}
+
+	void TearDown() override
+	{
+		ASSERT_TRUE(script.IsStackTop());
+	}
+
+protected:
+	Script::Engine script;
+	lua_State* L = script.State();
+};
+
+TEST_F(UnitScript_Allocation, ShouldPushIntegerWithoutAllocation)
+{
+	const AllocationCounter counter{ L };
+
+	Script::Stack< int32_t >::Push(L, 123);
+	EXPECT_EQ(Script::Stack< int32_t >::Get(L, -1), 123);
+	lua_pop(L, 1);
+
+	EXPECT_EQ(counter.GetAllocations(), size_t{ 0 });
+	EXPECT_EQ(counter.GetLuaAllocations(), size_t{ 0 });
+}
+
+TEST_F(UnitScript_Allocation, ShouldPushInternedStringWithoutAllocation)
+{
+	const std::string value = "FooBar";
+
+	Script::Stack< std::string >::Push(L, value);
+	lua_pop(L, 1);
+
+	const AllocationCounter counter{ L };
+
+	Script::Stack< std::string >::Push(L, value);
+	lua_pop(L, 1);
+
+	EXPECT_EQ(counter.GetAllocations(), size_t{ 0 });
+	EXPECT_EQ(counter.GetLuaAllocations(), size_t{ 0 });
+}
+
+TEST_F(UnitScript_Allocation, ShouldReadGlobal)
+{
+	const AllocationCounter counter{ L };
+
+	EXPECT_EQ(script[ "Variable" ].Get< int32_t >(), 123);
+
+	// Reference::Pointer and its shared_ptr control block.
+	EXPECT_EQ(counter.GetAllocations(), size_t{ 2 });
+	EXPECT_EQ(counter.GetLuaAllocations(), size_t{ 0 });
+}
+
+TEST_F(UnitScript_Allocation, ShouldReadGlobalByKey)
+{
+	EXPECT_EQ(script[ Script::Key< "Variable" >{} ].Get< int32_t >(), 123);
+
+	const AllocationCounter counter{ L };
+
+	EXPECT_EQ(script[ Script::Key< "Variable" >{} ].Get< int32_t >(), 123);
+
+	// Reference::Pointer and its shared_ptr control block.
+	EXPECT_EQ(counter.GetAllocations(), size_t{ 2 });
+	EXPECT_EQ(counter.GetLuaAllocations(), size_t{ 0 });
+}
+
+TEST_F(UnitScript_Allocation, ShouldScanTableWithoutAllocation)
+{
+	const Script::Reference table = script.Execute(R"(
+		local values = {};
+		for i = 1, 1000 do
+			values[i] = i;
+		end
+		return values;
+	)");
+
+	const AllocationCounter counter{ L };
+
+	const auto range = table.Array< int32_t >();
+	EXPECT_NE(std::ranges::find(range, 999), range.end());
+
+	EXPECT_EQ(counter.GetAllocations(), size_t{ 0 });
+	EXPECT_EQ(counter.GetLuaAllocations(), size_t{ 0 });
+}
+
+TEST_F(UnitScript_Allocation, ShouldCallBoundFunctionWithoutAllocation)
+{
+	lua_getglobal(L, "CallBoundFunction");
+
+	const AllocationCounter counter{ L };
+
+	ASSERT_EQ(lua_pcall(L, 0, 1, 0), 0);
+	EXPECT_EQ(Script::Stack< int32_t >::Get(L, -1), 10);
+	lua_pop(L, 1);
+
+	EXPECT_EQ(counter.GetAllocations(), size_t{ 0 });
+	EXPECT_EQ(counter.GetLuaAllocations(), size_t{ 0 });
+}
+
+TEST_F(UnitScript_Allocation, ShouldInvokeLuaCallbackWithoutAllocation)
+{
+	const auto callback = script[ "Callback" ].Get< std::function< int32_t(int32_t) > >();
+
+	const AllocationCounter counter{ L };
+
+	EXPECT_EQ(callback(1), 2);
+
+	EXPECT_EQ(counter.GetAllocations(), size_t{ 0 });
+	EXPECT_EQ(counter.GetLuaAllocations(), size_t{ 0 });
+}
+
+TEST_F(UnitScript_Allocation, ShouldInvokeLuaReference)
+{
+	const Script::Reference callback = script[ "Callback" ];
+	// The first result reference may grow the registry, later ones reuse its free slot.
+	EXPECT_EQ(callback(1).Get< int32_t >(), 2);
+
+	const AllocationCounter counter{ L };
+
+	EXPECT_EQ(callback(1).Get< int32_t >(), 2);
+
+	// Reference::Pointer and its shared_ptr control block of the result.
+	EXPECT_EQ(counter.GetAllocations(), size_t{ 2 });
+	EXPECT_EQ(counter.GetLuaAllocations(), size_t{ 0 });
+}
@@ -1,14 +1,56 @@
 #include <Framework/Script/Engine.hpp>
 
+#include <Framework/Script/BindingStatistics.hpp>
+#include <Framework/Script/Bundle.hpp>
+#include <Framework/Script/Channel.hpp>
+#include <Framework/Script/EngineFactory.hpp>
+#include <Framework/Script/EventBus.hpp>
+#include <Framework/Script/JitControl.hpp>
 #include <Framework/Script/Metatable.hpp>
 #include <Framework/Script/Object.hpp>
+#include <Framework/Script/Reloader.hpp>
 #include <Framework/Script/Sandbox.hpp>
+#include <Framework/Script/SharedData.hpp>
+#include <Framework/Script/Task.hpp>
+#include <Framework/Script/Metrics.hpp>
+#include <Framework/Script/TraceDiagnostics.hpp>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
 using namespace testing;
 
+namespace
+{
+
+struct Position
+{
+	double x = 0.0;
+	double y = 0.0;
+};
+
+struct Payload
+{
+	std::string name = {};
+	int32_t id = 0;
+	Position position = {};
+	std::vector< int32_t > values = {};
+	std::optional< bool > flag = {};
+};
+
+// Taken while the test binary initializes its statics, before main.
+const int32_t EarlyKeyIndex = Script::Key< "EarlyKey" >::Index();
+
+} // namespace
+
+SCRIPT_FIELDS(Position, x, y);
+SCRIPT_FIELDS(Payload, name, id, position, values, flag);
+
 TEST(UnitScript_Utils, ShouldDemangleClassName)
 {
 	EXPECT_EQ("int", Script::Utils::DemangleClassName< int >());
@@ -22,6 +64,26 @@ TEST(UnitScript_Utils, ShouldDemangleClassNameWithNamespace)
 	EXPECT_EQ("ScriptEngine", (Script::Utils::DemangleClassName< Script::Engine >()));
 }
 
+TEST(UnitScript_Utils, ShouldDemangleClassNameFromThreads)
+{
+	std::atomic< int32_t > mismatches = 0;
+
+	std::vector< std::thread > threads = {};
+	for (int32_t thread = 0; thread < 4; ++thread) {
+		threads.emplace_back([ &mismatches, thread ]() {
+			for (int32_t i = 0; i < 1000; ++i) {
+				const std::string name = thread % 2 ? Script::Utils::DemangleClassName< Script::Engine >() : Script::Utils::DemangleClassName< int >();
+				mismatches += name != (thread % 2 ? "ScriptEngine" : "int");
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(mismatches, 0);
+}
+
 class UnitScript : public testing::Test
 {
 protected:
@@ -322,6 +384,416 @@ TEST_F(UnitScript_Global, ShouldAssignVectorOfPairsValue)
 	EXPECT_EQ((script[ "Variable" ].Get< VariantType >()), (VariantType{ 123, "foo" }));
 }
 
+class UnitScript_Aggregate : public UnitScript
+{
+};
+
+TEST_F(UnitScript_Aggregate, ShouldPushAggregate)
+{
+	script.SetGlobal("Variable", Payload{ .name = "FooBar", .id = 7, .position = { 1.5, -2.0 }, .values = { 1, 2, 3 }, .flag = true });
+
+	EXPECT_EQ(script.Execute(R"(return Variable.name)").Get< std::string >(), "FooBar");
+	EXPECT_EQ(script.Execute(R"(return Variable.id)").Get< int32_t >(), 7);
+	EXPECT_EQ(script.Execute(R"(return Variable.position.x + Variable.position.y)").Get< double >(), -0.5);
+	EXPECT_EQ(script.Execute(R"(return #Variable.values)").Get< int32_t >(), 3);
+	EXPECT_TRUE(script.Execute(R"(return Variable.flag)").Get< bool >());
+}
+
+TEST_F(UnitScript_Aggregate, ShouldGetAggregate)
+{
+	const Payload payload = script.Execute(R"(return { name = "FooBar", id = 7, position = { x = 3, y = 4 }, values = { 5, 6 } })").Get< Payload >();
+
+	EXPECT_EQ(payload.name, "FooBar");
+	EXPECT_EQ(payload.id, 7);
+	EXPECT_EQ(payload.position.x, 3.0);
+	EXPECT_EQ(payload.position.y, 4.0);
+	EXPECT_THAT(payload.values, ElementsAre(5, 6));
+	EXPECT_FALSE(payload.flag.has_value());
+}
+
+class UnitScript_Key : public UnitScript
+{
+};
+
+TEST_F(UnitScript_Key, ShouldAccessFieldsByKey)
+{
+	ASSERT_TRUE(script.ExecuteRaw(R"(Variable = { Value = 123 })"));
+
+	EXPECT_EQ(script[ Script::Key< "Variable" >{} ][ Script::Key< "Value" >{} ].Get< int32_t >(), 123);
+
+	script.GetGlobal().SetField(Script::Key< "Other" >{}, std::string{ "FooBar" });
+	EXPECT_EQ(script[ "Other" ].Get< std::string >(), "FooBar");
+
+	script.GetMetatable("KeyMetatable")->SetField(Script::Key< "Value" >{}, int32_t{ 7 });
+	EXPECT_EQ(script.Execute(R"(return KeyMetatable.Value)").Get< int32_t >(), 7);
+
+	EXPECT_EQ(Script::Key< "Variable" >::Index(), Script::Key< "Variable" >::Index());
+	EXPECT_NE(Script::Key< "Variable" >::Index(), Script::Key< "Value" >::Index());
+}
+
+TEST_F(UnitScript_Key, ShouldRegisterKeysUsedDuringStaticInitialization)
+{
+	EXPECT_NE(EarlyKeyIndex, 0);
+	EXPECT_EQ(EarlyKeyIndex, Script::Key< "EarlyKey" >::Index());
+	EXPECT_NE(EarlyKeyIndex, Script::Key< "Variable" >::Index());
+}
+
+TEST_F(UnitScript_Key, ShouldNotServeAnotherNameFromTheSameSlot)
+{
+	lua_State* L = script.State();
+	const int32_t index = Script::Key< "Value" >::Index();
+
+	Script::Keys::PushTable(L);
+	Script::Keys::Push(L, -1, index, "Value");
+	EXPECT_STREQ(lua_tostring(L, -1), "Value");
+	lua_pop(L, 1);
+
+	Script::Keys::Push(L, -1, index, "Other");
+	EXPECT_STREQ(lua_tostring(L, -1), "Other");
+	lua_pop(L, 2);
+}
+
+TEST_F(UnitScript_Key, ShouldKeepEmbeddedZeros)
+{
+	const std::string value{ "Foo\0Bar", 7 };
+	script.SetGlobal("Variable", value);
+
+	EXPECT_EQ(script.Execute(R"(return #Variable)").Get< int32_t >(), 7);
+	EXPECT_EQ(script[ "Variable" ].Get< std::string >(), value);
+}
+
+class UnitScript_Proxy : public UnitScript
+{
+};
+
+TEST_F(UnitScript_Proxy, ShouldAccessVectorWithoutCopy)
+{
+	std::vector< int32_t > values = { 1, 2, 3 };
+	script.SetGlobal("Variable", Script::Proxy< std::vector< int32_t > >::Borrow(values));
+
+	EXPECT_EQ(script.Execute(R"(return #Variable)").Get< int32_t >(), 3);
+	EXPECT_EQ(script.Execute(R"(return Variable[2])").Get< int32_t >(), 2);
+	EXPECT_EQ(script.Execute(R"(return Variable[4])").GetType(), Script::VariableType::Nil);
+
+	EXPECT_TRUE(script.ExecuteRaw(R"(Variable[1] = 10; Variable[#Variable + 1] = 4)"));
+	EXPECT_THAT(values, ElementsAre(10, 2, 3, 4));
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() Variable[10] = 1 end))").Get< bool >());
+
+	EXPECT_EQ(script.Execute(R"(
+		local sum = 0;
+		for index, value in Variable() do
+			sum = sum + index * value;
+		end
+		return sum;
+	)")
+				  .Get< int32_t >(),
+		10 + 4 + 9 + 16);
+
+	const std::vector< int32_t > snapshot = script.Execute(R"(return Variable("snapshot"))").Get< std::vector< int32_t > >();
+	EXPECT_EQ(snapshot, values);
+
+	script.RemoveGlobal("Variable");
+}
+
+TEST_F(UnitScript_Proxy, ShouldAccessSharedMap)
+{
+	using Container = std::map< std::string, int32_t >;
+
+	const std::shared_ptr< Container > values{ new Container{ { "A", 1 }, { "B", 2 } } };
+	script.SetGlobal("Variable", Script::Proxy< Container >{ values });
+
+	EXPECT_EQ(script.Execute(R"(return Variable.B)").Get< int32_t >(), 2);
+	EXPECT_EQ(script.Execute(R"(return Variable.C)").GetType(), Script::VariableType::Nil);
+
+	EXPECT_TRUE(script.ExecuteRaw(R"(Variable.C = 3; Variable.A = nil)"));
+	EXPECT_EQ(*values, (Container{ { "B", 2 }, { "C", 3 } }));
+
+	EXPECT_EQ(script.Execute(R"(
+		local keys = "";
+		for key, value in Variable() do
+			keys = keys .. key .. value;
+		end
+		return keys;
+	)")
+				  .Get< std::string >(),
+		"B2C3");
+
+	const Script::Proxy< Container > proxy = script[ "Variable" ].Get< Script::Proxy< Container > >();
+	EXPECT_EQ(proxy.GetShared(), values);
+
+	script.RemoveGlobal("Variable");
+}
+
+TEST_F(UnitScript_Proxy, ShouldRejectOtherValuesAsProxy)
+{
+	std::vector< int32_t > values = { 1, 2, 3 };
+	script.SetGlobal("Variable", Script::Proxy< std::vector< int32_t > >::Borrow(values));
+
+	EXPECT_FALSE(script.Execute(R"(local next = Variable(); return pcall(next, 1))").Get< bool >());
+	EXPECT_FALSE(script.Execute(R"(return pcall(getmetatable(Variable).__len, {}))").Get< bool >());
+	EXPECT_FALSE(script.Execute(R"(return pcall(getmetatable(Variable).__index, newproxy(), 1))").Get< bool >());
+	EXPECT_EQ(script.Execute(R"(local next = Variable(); return select(2, next(Variable, 1)))").Get< int32_t >(), 2);
+
+	script.RemoveGlobal("Variable");
+}
+
+TEST_F(UnitScript_Proxy, ShouldSurviveManualCollection)
+{
+	using Container = std::vector< int32_t >;
+
+	const std::shared_ptr< Container > values{ new Container{ 1, 2, 3 } };
+	script.SetGlobal("Variable", Script::Proxy< Container >{ values });
+
+	EXPECT_FALSE(script.Execute(R"(return pcall(getmetatable(Variable).__gc, 1))").Get< bool >());
+	EXPECT_EQ(values.use_count(), 2);
+
+	EXPECT_TRUE(script.ExecuteRaw(R"(getmetatable(Variable).__gc(Variable); getmetatable(Variable).__gc(Variable))"));
+	EXPECT_EQ(values.use_count(), 1);
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() return #Variable end))").Get< bool >());
+
+	script.RemoveGlobal("Variable");
+}
+
+class UnitScript_Channel : public UnitScript
+{
+};
+
+TEST_F(UnitScript_Channel, ShouldExchangeValuesBetweenEngines)
+{
+	const Script::ChannelPtr channel{ new Script::Channel{ 3 } };
+	EXPECT_EQ(channel->GetCapacity(), 4u);
+
+	Script::Engine other;
+	script.SetGlobal("Channel", channel);
+	other.SetGlobal("Channel", channel);
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		assert(Channel:Send({ 1, -2, 3.5, name = "Foo\0Bar", nested = { flag = true, [ 10 ] = false } }));
+		assert(Channel:SendBatch({ "A", "B", "C", "D" }) == 3);
+	)"));
+	EXPECT_FALSE(channel->Send(&script, 123));
+	EXPECT_EQ(channel->GetSize(), 4u);
+
+	ASSERT_TRUE(other.ExecuteRaw(R"(
+		local ok, value = Channel:Receive();
+		assert(ok and value[ 1 ] == 1 and value[ 2 ] == -2 and value[ 3 ] == 3.5);
+		assert(value.name == "Foo\0Bar" and value.nested.flag == true and value.nested[ 10 ] == false);
+
+		local values, count = Channel:ReceiveBatch(8);
+		assert(count == 3 and table.concat(values) == "ABC");
+		assert(not Channel:Receive() and #Channel == 0);
+	)"));
+
+	EXPECT_TRUE(channel->Send(&other, std::vector< int32_t >{ 1, 2, 3 }));
+	EXPECT_EQ(channel->Receive< std::vector< int32_t > >(&script), (std::vector< int32_t >{ 1, 2, 3 }));
+	EXPECT_FALSE(channel->Receive< int32_t >(&script).has_value());
+
+	const Script::ChannelStatistics statistics = channel->GetStatistics();
+	EXPECT_EQ(statistics.sent, 5u);
+	EXPECT_EQ(statistics.received, 5u);
+	EXPECT_EQ(statistics.rejected, 2u);
+	EXPECT_GT(statistics.bytes, 0u);
+
+	EXPECT_FALSE(script.Execute(R"(
+		local cyclic = {};
+		cyclic.self = cyclic;
+		return pcall(Channel.Send, Channel, cyclic);
+	)").Get< bool >());
+
+	script.RemoveGlobal("Channel");
+	other.RemoveGlobal("Channel");
+}
+
+TEST_F(UnitScript_Channel, ShouldSurviveManualCollection)
+{
+	const Script::ChannelPtr channel{ new Script::Channel{ 4 } };
+	script.SetGlobal("Channel", channel);
+
+	EXPECT_FALSE(script.Execute(R"(return pcall(getmetatable(Channel).__gc, 1))").Get< bool >());
+	EXPECT_EQ(channel.use_count(), 2);
+
+	EXPECT_TRUE(script.ExecuteRaw(R"(getmetatable(Channel).__gc(Channel); getmetatable(Channel).__gc(Channel))"));
+	EXPECT_EQ(channel.use_count(), 1);
+	EXPECT_FALSE(script.Execute(R"(return pcall(Channel.Send, Channel, 1))").Get< bool >());
+
+	script.RemoveGlobal("Channel");
+}
+
+TEST_F(UnitScript_Channel, ShouldCollectMessagesFromProducerThreads)
+{
+	constexpr int32_t Producers = 4;
+	constexpr int32_t Messages = 1000;
+
+	const Script::ChannelPtr channel{ new Script::Channel{ 64 } };
+
+	std::vector< std::thread > threads = {};
+	for (int32_t producer = 0; producer < Producers; ++producer) {
+		threads.emplace_back([ channel, producer ]() {
+			Script::Engine engine;
+			engine.SetGlobal("Channel", channel);
+			engine.SetGlobal("Producer", producer);
+			static_cast< void >(engine.ExecuteRaw(R"(
+				for i = 1, 1000 do
+					while not Channel:Send({ producer = Producer, sequence = i }) do end
+				end
+				Channel = nil;
+			)"));
+		});
+	}
+
+	script.SetGlobal("Channel", channel);
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		Total = 0;
+		Last = {};
+		Ordered = true;
+	)"));
+
+	const Script::Reference drain = script.Execute(R"(
+		return function()
+			local values, count = Channel:ReceiveBatch(16);
+			for i = 1, count do
+				local value = values[ i ];
+				Ordered = Ordered and (Last[ value.producer ] or 0) + 1 == value.sequence;
+				Last[ value.producer ] = value.sequence;
+			end
+			Total = Total + count;
+		end
+	)");
+
+	while (script[ "Total" ].Get< int32_t >() < Producers * Messages) {
+		static_cast< void >(drain());
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_TRUE(script[ "Ordered" ].Get< bool >());
+	EXPECT_EQ(channel->GetStatistics().received, static_cast< uint64_t >(Producers * Messages));
+	script.RemoveGlobal("Channel");
+}
+
+class UnitScript_SharedData : public UnitScript
+{
+protected:
+	using Node = Script::SharedData::Node;
+};
+
+TEST_F(UnitScript_SharedData, ShouldReadSharedDataFromEngines)
+{
+	const Script::SharedDataPtr data{ new Script::SharedData{ Node{ Node::Table{
+		{ "name", "Config" },
+		{ "items", Node::Array({ Node{ Node::Table{ { "id", 1 }, { "name", "Sword" } } }, Node{ Node::Table{ { "id", 2 }, { "name", "Shield" } } } }) },
+		{ "limits", Node::Table{ { 1, 10 }, { 2, 20 }, { 100, 1000 }, { 0.5, "half" }, { true, "yes" } } },
+	} } } };
+	EXPECT_GT(data->GetMemoryUsage(), 0u);
+
+	Script::Engine other;
+	script.SetGlobal("Data", data);
+	other.SetGlobal("Data", data);
+
+	EXPECT_EQ(script.Execute(R"(return Data.name)").Get< std::string >(), "Config");
+	EXPECT_EQ(other.Execute(R"(return Data.items[ 2 ].name)").Get< std::string >(), "Shield");
+	EXPECT_EQ(script.Execute(R"(return #Data.items)").Get< int32_t >(), 2);
+	EXPECT_EQ(script.Execute(R"(return Data.limits[ 100 ] + Data.limits[ 2 ])").Get< int32_t >(), 1020);
+	EXPECT_EQ(script.Execute(R"(return Data.limits[ 0.5 ] .. Data.limits[ true ])").Get< std::string >(), "halfyes");
+	EXPECT_EQ(script.Execute(R"(return #Data.limits)").Get< int32_t >(), 2);
+	EXPECT_EQ(script.Execute(R"(return Data.missing)").GetType(), Script::VariableType::Nil);
+
+	EXPECT_EQ(other.Execute(R"(
+		local count, sum = 0, 0;
+		for key, value in Data.limits() do
+			count = count + 1;
+			sum = sum + (type(value) == "number" and value or 0);
+		end
+		return count * 10000 + sum;
+	)").Get< int32_t >(), 5 * 10000 + 1030);
+
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() Data.name = "Foo" end))").Get< bool >());
+	EXPECT_EQ(script[ "Data" ].Get< Script::SharedDataPtr >(), data);
+
+	script.RemoveGlobal("Data");
+	other.RemoveGlobal("Data");
+}
+
+TEST_F(UnitScript_SharedData, ShouldRejectInvalidKeys)
+{
+	const Node duplicate = Node::Table{ { "Foo", 1 }, { "Foo", 2 } };
+	EXPECT_THROW(Script::SharedData{ duplicate }, std::string);
+
+	const Node tableKey = Node::Table{ { Node{ Node::Table{} }, 1 } };
+	EXPECT_THROW(Script::SharedData{ tableKey }, std::string);
+}
+
+TEST_F(UnitScript_SharedData, ShouldSurviveManualCollection)
+{
+	const Script::SharedDataPtr data{ new Script::SharedData{ Node{ Node::Table{ { "name", "Config" } } } } };
+	script.SetGlobal("Data", data);
+
+	EXPECT_FALSE(script.Execute(R"(return pcall(getmetatable(Data).__gc, 1))").Get< bool >());
+	EXPECT_EQ(data.use_count(), 2);
+
+	EXPECT_TRUE(script.ExecuteRaw(R"(getmetatable(Data).__gc(Data); getmetatable(Data).__gc(Data))"));
+	EXPECT_EQ(data.use_count(), 1);
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() return Data.name end))").Get< bool >());
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() return #Data end))").Get< bool >());
+
+	script.RemoveGlobal("Data");
+}
+
+class UnitScript_TableRange : public UnitScript
+{
+};
+
+TEST_F(UnitScript_TableRange, ShouldIterateArrayLazily)
+{
+	const Script::Reference table = script.Execute(R"(return { 1, 2, 3, 4, 5 })");
+	const auto range = table.Array< int32_t >();
+
+	EXPECT_EQ(*std::ranges::find(range, 3), 3);
+	EXPECT_EQ(std::ranges::find(range, 6), range.end());
+
+	int32_t sum = 0;
+	for (const int32_t value : range | std::views::filter([](const int32_t value) { return value % 2; })) {
+		sum += value;
+	}
+	EXPECT_EQ(sum, 9);
+}
+
+TEST_F(UnitScript_TableRange, ShouldIteratePairsLazily)
+{
+	const Script::Reference table = script.Execute(R"(return { A = 1, B = 2, C = 3 })");
+
+	std::map< std::string, int32_t > values = {};
+	for (const auto& [ key, value ] : table.Pairs< std::string, int32_t >()) {
+		values.emplace(key, value);
+	}
+	EXPECT_EQ(values, (std::map< std::string, int32_t >{ { "A", 1 }, { "B", 2 }, { "C", 3 } }));
+
+	const auto range = table.Pairs< std::string, int32_t >();
+	const auto it = std::ranges::find_if(range, [](const auto& pair) { return pair.second == 2; });
+	ASSERT_NE(it, range.end());
+	EXPECT_EQ((*it).first, "B");
+}
+
+TEST_F(UnitScript_TableRange, ShouldIterateNumericKeysAsStrings)
+{
+	const Script::Reference table = script.Execute(R"(return { 10, 20, [ 2.5 ] = 30 })");
+
+	std::map< std::string, int32_t > values = {};
+	for (const auto& [ key, value ] : table.Pairs< std::string, int32_t >()) {
+		values.emplace(key, value);
+	}
+	EXPECT_EQ(values, (std::map< std::string, int32_t >{ { "1", 10 }, { "2", 20 }, { "2.5", 30 } }));
+}
+
+TEST_F(UnitScript_TableRange, ShouldIterateNothingForNonTable)
+{
+	const Script::Reference value = script.Execute(R"(return 123)");
+
+	EXPECT_TRUE(value.Array< int32_t >().begin() == std::default_sentinel);
+	EXPECT_TRUE((value.Pairs< int32_t, int32_t >().begin() == std::default_sentinel));
+}
+
 class UnitScript_GlobalFunction : public UnitScript
 {
 protected:
@@ -465,7 +937,7 @@ TEST_F(UnitScript_Class, ShouldCallStaticFunction)
 TEST_F(UnitScript_Class, ShouldCreateBaseClassAndCallObjectFunctions)
 {
 	ASSERT_TRUE(script.ExecuteRaw(R"(Variable = BaseClass.Create("FooBar"))"));
-	ASSERT_EQ(script[ "Variable" ].GetType(), Script::VariableType::LightUserData);
+	ASSERT_EQ(script[ "Variable" ].GetType(), Script::VariableType::CData);
 
 	EXPECT_EQ(script.Execute(R"(return Variable:GetFunction())").Get< std::string >(), "FooBar");
 	EXPECT_TRUE(script.ExecuteRaw(R"(Variable:SetFunction("FooBar_Set"))"));
@@ -476,7 +948,7 @@ TEST_F(UnitScript_Class, ShouldCreateBaseClassAndCallObjectFunctions)
 TEST_F(UnitScript_Class, ShouldCreateDerivedClassAndCallObjectFunctions)
 {
 	ASSERT_TRUE(script.ExecuteRaw(R"(Variable = BaseClass.Create("FooBar"))"));
-	ASSERT_EQ(script[ "Variable" ].GetType(), Script::VariableType::LightUserData);
+	ASSERT_EQ(script[ "Variable" ].GetType(), Script::VariableType::CData);
 
 	EXPECT_EQ(script.Execute(R"(return Variable:GetFunction())").Get< std::string >(), "FooBar");
 	EXPECT_TRUE(script.ExecuteRaw(R"(Variable:SetFunction("FooBar_Set"))"));
@@ -493,6 +965,53 @@ TEST_F(UnitScript_Class, ShouldCreateAndCallAddFunction)
 	EXPECT_TRUE(script.ExecuteRaw(R"(Variable:Destroy())"));
 }
 
+TEST_F(UnitScript_Class, ShouldDispatchRawPointersByType)
+{
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		Base = BaseClass.Create("Base");
+		Derived = DerivedClass.Create("Derived");
+		Base:SetFunction("Base_Set");
+		Derived:SetFunction("Derived_Set");
+	)"));
+
+	EXPECT_EQ(script.Execute(R"(return Base:GetFunction())").Get< std::string >(), "Base_Set");
+	EXPECT_EQ(script.Execute(R"(return Derived:GetFunction())").Get< std::string >(), "Derived_Set_Derived");
+	EXPECT_TRUE(script.Execute(R"(return tostring(Base):find("struct Script_", 1, true) ~= nil)").Get< bool >());
+
+	EXPECT_TRUE(script.ExecuteRaw(R"(Base:Destroy(); Derived:Destroy())"));
+}
+
+TEST_F(UnitScript_Class, ShouldRejectForeignPointers)
+{
+	script.SetGlobal("Read", std::function{ [](BaseClass* object) {
+		return object ? object->GetFunction() : std::string{ "nil" };
+	} });
+
+	EXPECT_EQ(script.Execute(R"(return Read(nil))").Get< std::string >(), "nil");
+	EXPECT_FALSE(script.Execute(R"(return pcall(Read, require("ffi").cast("void*", 16)))").Get< bool >());
+	EXPECT_FALSE(script.Execute(R"(return pcall(Read, require("ffi").new("int[1]")))").Get< bool >());
+	EXPECT_FALSE(script.Execute(R"(return pcall(BaseClass.GetFunction, {}))").Get< bool >());
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(Derived = DerivedClass.Create("Derived"))"));
+	EXPECT_EQ(script.Execute(R"(return Read(Derived))").Get< std::string >(), "Derived");
+	EXPECT_TRUE(script.ExecuteRaw(R"(Derived:Destroy())"));
+}
+
+TEST_F(UnitScript_Class, ShouldReachFieldsAddedAfterFirstPush)
+{
+	ASSERT_TRUE(script.ExecuteRaw(R"(Base = BaseClass.Create("Base"))"));
+
+	script.GetMetatable(Script::Utils::DemangleClassName< BaseClass >())
+		->SetField("Describe", std::function{ [](BaseClass* object) { return "Described_" + object->GetFunction(); } })
+		->SetField("__tostring", &BaseClass::GetFunction);
+
+	EXPECT_EQ(script.Execute(R"(return Base:Describe())").Get< std::string >(), "Described_Base");
+	EXPECT_EQ(script.Execute(R"(return tostring(Base))").Get< std::string >(), "Base");
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() return Base - Base; end))").Get< bool >());
+
+	EXPECT_TRUE(script.ExecuteRaw(R"(Base:Destroy())"));
+}
+
 class UnitScript_SharedClass : public UnitScript_Metatable
 {
 protected:
@@ -556,6 +1075,301 @@ TEST_F(UnitScript_SharedClass, ShouldCreateDerivedClassAndCallObjectFunctions)
 	EXPECT_TRUE(script.ExecuteRaw(R"(Variable = nil)"));
 }
 
+TEST_F(UnitScript_SharedClass, ShouldReuseUserdataWithIdentityCache)
+{
+	const BaseClassPtr object{ new BaseClass{ "FooBar" } };
+	script.SetGlobal("GetObject", std::function{ [ object ]() {
+		return object;
+	} });
+
+	EXPECT_FALSE(script.HasIdentityCache());
+	EXPECT_FALSE(script.Execute(R"(return rawequal(GetObject(), GetObject()))").Get< bool >());
+
+	script.SetIdentityCache(true);
+	EXPECT_TRUE(script.HasIdentityCache());
+	EXPECT_TRUE(script.Execute(R"(return rawequal(GetObject(), GetObject()))").Get< bool >());
+	EXPECT_EQ(script.Execute(R"(return GetObject():GetFunction())").Get< std::string >(), "FooBar");
+
+	script.CollectGarbage();
+	EXPECT_EQ(script.Execute(R"(return GetObject():GetFunction())").Get< std::string >(), "FooBar");
+
+	script.SetIdentityCache(false);
+	EXPECT_FALSE(script.HasIdentityCache());
+
+	script.RemoveGlobal("GetObject");
+}
+
+TEST_F(UnitScript_SharedClass, ShouldSendObjectsThroughChannel)
+{
+	const Script::ChannelPtr channel{ new Script::Channel{ 4 } };
+	script.SetGlobal("Channel", channel);
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(assert(Channel:Send({ object = DerivedClass.Create("FooBar") })))"));
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		local ok, value = Channel:Receive();
+		Variable = value.object;
+	)"));
+	EXPECT_EQ(script.Execute(R"(return Variable:GetFunction())").Get< std::string >(), "FooBar");
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(assert(Channel:Send(Variable)))"));
+	Script::Engine other;
+	const std::optional< DerivedClassPtr > object = channel->Receive< DerivedClassPtr >(&other);
+	ASSERT_TRUE(object.has_value() && *object);
+	EXPECT_EQ((*object)->GetFunction(), "FooBar");
+	EXPECT_EQ(object->get(), script[ "Variable" ].Get< DerivedClassPtr >().get());
+
+	EXPECT_FALSE(script.Execute(R"(return pcall(Channel.Send, Channel, print))").Get< bool >());
+
+	script.RemoveGlobal("Channel");
+	script.RemoveGlobal("Variable");
+}
+
+TEST_F(UnitScript_SharedClass, ShouldRejectOtherUserdataOfTheSameSize)
+{
+	using Node = Script::SharedData::Node;
+
+	script.SetGlobal("Data", Script::SharedDataPtr{ new Script::SharedData{ Node{ Node::Table{ { "name", "Config" } } } } });
+	script.SetGlobal("Take", std::function{ [](const BaseClassPtr& object) {
+		return object->GetFunction();
+	} });
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(Variable = BaseClass.Create("FooBar"))"));
+	EXPECT_EQ(script.Execute(R"(return Take(Variable))").Get< std::string >(), "FooBar");
+	EXPECT_FALSE(script.Execute(R"(return pcall(Take, Data))").Get< bool >());
+	EXPECT_FALSE(script.Execute(R"(return pcall(Variable.GetFunction, Data))").Get< bool >());
+	EXPECT_FALSE(script[ "Data" ].Get< BaseClassPtr >());
+	EXPECT_EQ(script.Execute(R"(return Data.name)").Get< std::string >(), "Config");
+
+	script.RemoveGlobal("Take");
+	script.RemoveGlobal("Data");
+	script.RemoveGlobal("Variable");
+	script.CollectGarbage();
+}
+
+TEST_F(UnitScript_Class, ShouldCollectBindingStatistics)
+{
+	if (!Script::BindingStatistics::IsEnabled()) {
+		EXPECT_TRUE(Script::BindingStatistics::Snapshot().empty());
+		GTEST_SKIP();
+	}
+
+	Script::BindingStatistics::Reset();
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		Variable = BaseClass.Create("FooBar");
+		for i = 1, 10 do
+			Variable:GetFunction();
+		end
+		Variable:Destroy();
+	)"));
+
+	const std::string name = Script::Utils::DemangleClassName< BaseClass >() + ".GetFunction";
+	const std::vector< Script::BindingStatistics::Record > records = Script::BindingStatistics::Snapshot();
+	const auto record = std::find_if(records.begin(), records.end(), [ &name ](const auto& record) {
+		return record.name == name;
+	});
+
+	ASSERT_NE(record, records.end());
+	EXPECT_EQ(record->calls, uint64_t{ 10 });
+	EXPECT_GE(record->total, record->max);
+
+	uint64_t histogramCalls = 0;
+	for (const auto& [ upperBound, calls ] : record->histogram) {
+		histogramCalls += calls;
+	}
+	EXPECT_EQ(histogramCalls, uint64_t{ 10 });
+}
+
+class UnitScript_Inheritance : public UnitScript
+{
+protected:
+	void SetUp() override
+	{
+		UnitScript::SetUp();
+
+		script.GetMetatable("Level0")->SetField("Name", std::function{ []() -> std::string { return "Level0"; } });
+		static_cast< void >(script.GetMetatable("Level1", "Level0"));
+		static_cast< void >(script.GetMetatable("Level2", "Level1"));
+		static_cast< void >(script.GetMetatable("Level3", "Level2"));
+	}
+};
+
+TEST_F(UnitScript_Inheritance, ShouldFlattenInheritedFields)
+{
+	EXPECT_EQ(script.Execute(R"(return rawget(Level3, "Name")())").Get< std::string >(), "Level0");
+}
+
+TEST_F(UnitScript_Inheritance, ShouldPropagateLateFields)
+{
+	script.GetMetatable("Level1")->SetField("Name", std::function{ []() -> std::string { return "Level1"; } });
+	script.GetMetatable("Level0")
+		->SetField("Name", std::function{ []() -> std::string { return "Level0_Late"; } })
+		->SetField("Late", std::function{ []() -> std::string { return "Late"; } });
+
+	EXPECT_EQ(script.Execute(R"(return rawget(Level0, "Name")())").Get< std::string >(), "Level0_Late");
+	EXPECT_EQ(script.Execute(R"(return rawget(Level3, "Name")())").Get< std::string >(), "Level1");
+	EXPECT_EQ(script.Execute(R"(return rawget(Level3, "Late")())").Get< std::string >(), "Late");
+}
+
+TEST_F(UnitScript_Inheritance, ShouldSealDescendants)
+{
+	const Script::MetatablePtr metatable = script.GetMetatable("Level1");
+	EXPECT_FALSE(metatable->IsSealed());
+
+	metatable->Seal();
+
+	EXPECT_TRUE(script.GetMetatable("Level3")->IsSealed());
+	EXPECT_FALSE(script.GetMetatable("Level0")->IsSealed());
+	EXPECT_THROW(script.GetMetatable("Level2")->SetField("Name", 0), std::string);
+	EXPECT_TRUE(script.Execute(R"(return getmetatable(Level3) == nil)").Get< bool >());
+	EXPECT_EQ(script.Execute(R"(return Level3.Name())").Get< std::string >(), "Level0");
+
+	script.GetMetatable("Level0")->SetField("Name", std::function{ []() -> std::string { return "Level0_Late"; } });
+	EXPECT_EQ(script.Execute(R"(return Level0.Name())").Get< std::string >(), "Level0_Late");
+	EXPECT_EQ(script.Execute(R"(return Level1.Name())").Get< std::string >(), "Level0");
+	EXPECT_EQ(script.Execute(R"(return Level3.Name())").Get< std::string >(), "Level0");
+}
+
+class UnitScript_Property : public UnitScript
+{
+protected:
+	class Entity
+	{
+	public:
+		Entity() { CreatedObjects++; }
+		virtual ~Entity() { CreatedObjects--; }
+
+		[[nodiscard]] auto GetName() const -> std::string { return mName; }
+		void SetName(const std::string& name) { mName = name + "_Set"; }
+
+		int32_t health = 100;
+		const int32_t id = 7;
+
+	protected:
+		std::string mName = "FooBar";
+	};
+
+	class DerivedEntity : public Entity
+	{
+	};
+
+	using EntityPtr = std::shared_ptr< Entity >;
+	using DerivedEntityPtr = std::shared_ptr< DerivedEntity >;
+
+	void SetUp() override
+	{
+		UnitScript::SetUp();
+
+		script.GetMetatable(Script::Utils::DemangleClassName< Entity >())
+			->RegisterReferenceDestructor(&script)
+			->SetProperty("health", &Entity::health)
+			->SetProperty("id", &Entity::id)
+			->SetProperty("name", &Entity::GetName, &Entity::SetName)
+			->SetProperty("readOnlyName", &Entity::GetName)
+			->SetField("GetName", &Entity::GetName);
+
+		script.GetMetatable(Script::Utils::DemangleClassName< DerivedEntity >(), Script::Utils::DemangleClassName< Entity >())
+			->RegisterReferenceDestructor(&script);
+	}
+};
+
+TEST_F(UnitScript_Property, ShouldReadAndWriteProperties)
+{
+	script.SetGlobal("Variable", EntityPtr{ new Entity{} });
+
+	EXPECT_EQ(script.Execute(R"(return Variable.health)").Get< int32_t >(), 100);
+	EXPECT_EQ(script.Execute(R"(return Variable.id)").Get< int32_t >(), 7);
+	EXPECT_EQ(script.Execute(R"(return Variable.name)").Get< std::string >(), "FooBar");
+	EXPECT_EQ(script.Execute(R"(return Variable:GetName())").Get< std::string >(), "FooBar");
+
+	EXPECT_TRUE(script.ExecuteRaw(R"(Variable.health = Variable.health + 1)"));
+	EXPECT_TRUE(script.ExecuteRaw(R"(Variable.name = "Name")"));
+	EXPECT_EQ(script.Execute(R"(return Variable.health)").Get< int32_t >(), 101);
+	EXPECT_EQ(script.Execute(R"(return Variable.readOnlyName)").Get< std::string >(), "Name_Set");
+
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() Variable.id = 1 end))").Get< bool >());
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() Variable.readOnlyName = "Name" end))").Get< bool >());
+	EXPECT_FALSE(script.Execute(R"(return pcall(function() Variable.unknown = 1 end))").Get< bool >());
+
+	script.RemoveGlobal("Variable");
+}
+
+TEST_F(UnitScript_Property, ShouldInheritProperties)
+{
+	script.SetGlobal("Variable", DerivedEntityPtr{ new DerivedEntity{} });
+	script.GetMetatable(Script::Utils::DemangleClassName< Entity >())->SetProperty("lateHealth", &Entity::health);
+
+	EXPECT_EQ(script.Execute(R"(return Variable.health)").Get< int32_t >(), 100);
+	EXPECT_EQ(script.Execute(R"(return Variable.lateHealth)").Get< int32_t >(), 100);
+	EXPECT_EQ(script.Execute(R"(return Variable:GetName())").Get< std::string >(), "FooBar");
+
+	script.RemoveGlobal("Variable");
+}
+
+class UnitScript_TypeRegistry : public UnitScript
+{
+protected:
+	struct First
+	{
+		int32_t first = 1;
+	};
+
+	struct Second
+	{
+		int32_t second = 2;
+	};
+
+	struct Combined : First
+		, Second
+	{
+		Combined() { CreatedObjects++; }
+		~Combined() { CreatedObjects--; }
+	};
+
+	struct Unrelated
+	{
+	};
+
+	void SetUp() override
+	{
+		UnitScript::SetUp();
+
+		Script::TypeRegistry::Register< Combined, First, Second >();
+		script.GetMetatable(Script::Utils::DemangleClassName< Combined >())->RegisterReferenceDestructor(&script);
+	}
+
+	lua_State* L = script.State();
+};
+
+TEST_F(UnitScript_TypeRegistry, ShouldCastWithPointerAdjustment)
+{
+	Script::Stack< std::shared_ptr< Combined > >::Push(L, std::shared_ptr< Combined >{ new Combined{} });
+
+	EXPECT_TRUE(Script::Stack< std::shared_ptr< Combined > >::Is(L, -1));
+	EXPECT_TRUE(Script::Stack< std::shared_ptr< First > >::Is(L, -1));
+	EXPECT_TRUE(Script::Stack< std::shared_ptr< Second > >::Is(L, -1));
+	EXPECT_FALSE(Script::Stack< std::shared_ptr< Unrelated > >::Is(L, -1));
+
+	EXPECT_EQ(Script::Stack< First* >::Get(L, -1)->first, 1);
+	EXPECT_EQ(Script::Stack< Second* >::Get(L, -1)->second, 2);
+	EXPECT_EQ(Script::Stack< std::shared_ptr< Second > >::Get(L, -1)->second, 2);
+
+	lua_pop(L, 1);
+}
+
+TEST_F(UnitScript_TypeRegistry, ShouldSelectVariantAlternativeByType)
+{
+	using VariantType = std::variant< std::shared_ptr< Unrelated >, std::shared_ptr< Second > >;
+
+	Script::Stack< std::shared_ptr< Combined > >::Push(L, std::shared_ptr< Combined >{ new Combined{} });
+
+	const VariantType variant = Script::Stack< VariantType >::Get(L, -1);
+	ASSERT_EQ(variant.index(), size_t{ 1 });
+	EXPECT_EQ(std::get< 1 >(variant)->second, 2);
+
+	lua_pop(L, 1);
+}
+
 class UnitScript_ObjectClass : public UnitScript
 {
 protected:
@@ -655,3 +1469,771 @@ TEST_F(UnitScript_Sandbox, ShouldCreateAndAssignVariable)
 	EXPECT_EQ(script[ "SandboxFirst" ][ "Variable" ].Get< int32_t >(), 124);
 	EXPECT_EQ(script[ "SandboxSecond" ][ "Variable" ].Get< int32_t >(), 224);
 }
+
+class UnitScript_Task : public UnitScript
+{
+protected:
+	inline static const std::string LongRunning = R"(
+		local Variable = 0;
+		for i = 1, 100000 do
+			Variable = Variable + i;
+		end
+		return Variable;
+	)";
+};
+
+TEST_F(UnitScript_Task, ShouldResumeUntilFinished)
+{
+	const Script::TaskPtr task = script.CreateTask(LongRunning);
+
+	while (task->Resume(1000)) {
+		ASSERT_EQ(task->GetStatus(), Script::TaskStatus::Suspended);
+	}
+
+	EXPECT_TRUE(task->IsFinished());
+	EXPECT_EQ(task->GetStatus(), Script::TaskStatus::Finished);
+	EXPECT_GT(task->GetSlices(), uint32_t{ 100 });
+	EXPECT_GE(task->GetInstructions(), uint64_t{ 100000 });
+	EXPECT_EQ(task->GetResult().Get< int64_t >(), int64_t{ 5000050000 });
+	EXPECT_FALSE(task->Resume(1000));
+}
+
+TEST_F(UnitScript_Task, ShouldKeepGlobalStateBetweenSlices)
+{
+	const Script::TaskPtr task = script.CreateTask(R"(
+		Variable = 0;
+		while Variable < 1000 do
+			Variable = Variable + 1;
+		end
+	)");
+
+	ASSERT_TRUE(task->Resume(100));
+	EXPECT_GT(script[ "Variable" ].Get< int32_t >(), 0);
+	EXPECT_LT(script[ "Variable" ].Get< int32_t >(), 1000);
+
+	while (task->Resume(100)) { }
+
+	EXPECT_EQ(script[ "Variable" ].Get< int32_t >(), 1000);
+}
+
+TEST_F(UnitScript_Task, ShouldDeferPreemptionInsideCCalls)
+{
+	const Script::TaskPtr task = script.CreateTask(R"(
+		local values = {};
+		for i = 1, 2000 do
+			values[ i ] = (i * 7919) % 2000;
+		end
+		table.sort(values, function(left, right) return left > right; end);
+		local text = string.gsub(string.rep("a", 2000), "a", function(character) return character .. "b"; end);
+		return values[ 1 ] + #text;
+	)");
+
+	while (task->Resume(1000)) {
+		ASSERT_EQ(task->GetStatus(), Script::TaskStatus::Suspended);
+	}
+
+	EXPECT_EQ(task->GetStatus(), Script::TaskStatus::Finished);
+	EXPECT_GT(task->GetSlices(), uint32_t{ 1 });
+	// Yielded slices ran their budget plus the instructions while the yield was deferred.
+	EXPECT_GT(task->GetInstructions(), uint64_t{ task->GetSlices() - 1 } * 1000);
+	EXPECT_EQ(task->GetResult().Get< int32_t >(), 1999 + 4000);
+}
+
+TEST_F(UnitScript_Task, ShouldFailOnRuntimeError)
+{
+	const Script::TaskPtr task = script.CreateTask(R"(error("FooBar"))");
+
+	EXPECT_THROW(task->Resume(1000), std::string);
+	EXPECT_EQ(task->GetStatus(), Script::TaskStatus::Failed);
+}
+
+TEST_F(UnitScript_Task, ShouldThrowOnSyntaxError)
+{
+	EXPECT_THROW(static_cast< void >(script.CreateTask(R"(local = )")), std::string);
+}
+
+class UnitScript_Reloader : public UnitScript
+{
+protected:
+	void SetUp() override
+	{
+		filename = std::filesystem::temp_directory_path() / "ScriptReloaderCounter.lua";
+		Write(1);
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove(filename);
+		UnitScript::TearDown();
+	}
+
+	void Write(const int32_t version, const std::string& extra = {})
+	{
+		const std::string number = std::to_string(version);
+		std::ofstream{ filename } << "local Module = { counter = 0 };\n"
+								  << "local calls = 0;\n"
+								  << "function Module.Next()\n"
+								  << "	calls = calls + 1;\n"
+								  << "	Module.counter = Module.counter + " << number << ";\n"
+								  << "	return Module.counter;\n"
+								  << "end\n"
+								  << "function Module.Calls() return calls; end\n"
+								  << "function Module.Version() return " << number << "; end\n"
+								  << extra << "\n"
+								  << "return Module;\n";
+	}
+
+	std::filesystem::path filename = {};
+};
+
+TEST_F(UnitScript_Reloader, ShouldSwapFunctionsAndKeepState)
+{
+	const Script::ReloaderPtr reloader = script.CreateReloader();
+	std::vector< Script::ReloadEvent > events = {};
+	reloader->SetCallback([ &events ](const Script::ReloadEvent& event) {
+		events.push_back(event);
+	});
+
+	static_cast< void >(reloader->Load("Counter", filename.string()));
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		Counter = require("Counter");
+		Counter.Next();
+		Counter.Next();
+	)"));
+
+	Write(10, R"(Module.Extra = "FooBar";)");
+	EXPECT_EQ(reloader->Poll(), 1u);
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_TRUE(events[ 0 ].success);
+	EXPECT_EQ(events[ 0 ].name, "Counter");
+
+	EXPECT_EQ(script.Execute(R"(return Counter.Version())").Get< int32_t >(), 10);
+	EXPECT_EQ(script.Execute(R"(return Counter.Next())").Get< int32_t >(), 12);
+	EXPECT_EQ(script.Execute(R"(return Counter.Calls())").Get< int32_t >(), 3);
+	EXPECT_EQ(script.Execute(R"(return Counter.Extra)").Get< std::string >(), "FooBar");
+	EXPECT_EQ(reloader->Poll(), 0u);
+
+	EXPECT_TRUE(reloader->Rollback("Counter"));
+	EXPECT_TRUE(events.back().rollback);
+	EXPECT_EQ(script.Execute(R"(return Counter.Version())").Get< int32_t >(), 1);
+	EXPECT_EQ(script.Execute(R"(return Counter.Next())").Get< int32_t >(), 13);
+	EXPECT_EQ(script.Execute(R"(return Counter.Extra)").GetType(), Script::VariableType::Nil);
+	EXPECT_FALSE(reloader->Rollback("Counter"));
+
+	script.RemoveGlobal("Counter");
+}
+
+TEST_F(UnitScript_Reloader, ShouldKeepModuleOnFailedCompile)
+{
+	const Script::ReloaderPtr reloader = script.CreateReloader();
+	std::vector< Script::ReloadEvent > events = {};
+	reloader->SetCallback([ &events ](const Script::ReloadEvent& event) {
+		events.push_back(event);
+	});
+
+	const Script::Reference counter = reloader->Load("Counter", filename.string());
+
+	std::ofstream{ filename } << "return {";
+	EXPECT_EQ(reloader->Poll(), 0u);
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_FALSE(events[ 0 ].success);
+	EXPECT_FALSE(events[ 0 ].error.empty());
+
+	EXPECT_EQ(counter[ "Version" ]().Get< int32_t >(), 1);
+	EXPECT_FALSE(reloader->Reload("Missing"));
+	EXPECT_THROW(static_cast< void >(reloader->Load("Missing", filename.string() + ".missing")), std::string);
+}
+
+class UnitScript_Bundle : public UnitScript
+{
+};
+
+TEST_F(UnitScript_Bundle, ShouldRequireModulesFromBundle)
+{
+	Script::BundleBuilder builder;
+	builder.Add("Foo", "return { value = 1 }");
+	builder.Add("Foo.Bar", "return require('Foo').value + 1");
+
+	script.AddBundle(Script::Bundle::FromMemory(builder.Build()));
+	EXPECT_EQ(script.Execute(R"(return require("Foo.Bar"))").Get< int32_t >(), 2);
+	EXPECT_THAT(script.Execute(R"(return select(2, pcall(require, "Missing")))").Get< std::string >(), HasSubstr("in bundle"));
+
+	builder.Compile();
+	Script::Engine other;
+	other.AddBundle(Script::Bundle::FromMemory(builder.Build()));
+	EXPECT_EQ(other.Execute(R"(return require("Foo.Bar"))").Get< int32_t >(), 2);
+
+	EXPECT_THROW(static_cast< void >(Script::Bundle::FromMemory("FooBar")), std::string);
+}
+
+TEST_F(UnitScript_Bundle, ShouldMapBundleBuiltFromDirectory)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "ScriptBundle";
+	std::filesystem::create_directories(directory / "Package");
+	std::ofstream{ directory / "Main.lua" } << "return require('Package').Sub.value * 2";
+	std::ofstream{ directory / "Package" / "init.lua" } << "return { Sub = require('Package.Sub') }";
+	std::ofstream{ directory / "Package" / "Sub.lua" } << "return { value = 21 }";
+
+	Script::BundleBuilder builder;
+	builder.AddDirectory(directory);
+	builder.Write((directory / "Modules.bundle").string());
+
+	const Script::BundlePtr bundle = Script::Bundle::Open((directory / "Modules.bundle").string());
+	std::filesystem::remove_all(directory);
+
+	EXPECT_EQ(bundle->GetCount(), 3u);
+	EXPECT_TRUE(bundle->Find("Package.Sub").has_value());
+	EXPECT_FALSE(bundle->Find("Package.init").has_value());
+
+	script.AddBundle(bundle);
+	EXPECT_EQ(script.Execute(R"(return require("Main"))").Get< int32_t >(), 42);
+}
+
+class UnitScript_Profiler : public UnitScript
+{
+};
+
+TEST_F(UnitScript_Profiler, ShouldSampleLuaCallStacks)
+{
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		function BusyFunction(seconds)
+			local Variable = 0;
+			local finish = os.clock() + seconds;
+			while os.clock() < finish do
+				Variable = Variable + 1;
+			end
+			return Variable;
+		end
+	)"));
+
+	script.StartProfiler(std::chrono::milliseconds{ 1 });
+	ASSERT_TRUE(script.ExecuteRaw(R"(BusyFunction(0.2))"));
+	const Script::Profile profile = script.StopProfiler();
+
+	EXPECT_GT(profile.GetSamples(), uint64_t{ 0 });
+	EXPECT_THAT(profile.ToFolded(), HasSubstr("BusyFunction"));
+	EXPECT_TRUE(script.StopProfiler().stacks.empty());
+}
+
+TEST_F(UnitScript_Profiler, ShouldRejectSecondEngine)
+{
+	Script::Engine other;
+
+	script.StartProfiler();
+	EXPECT_THROW(other.StartProfiler(), std::string);
+	static_cast< void >(script.StopProfiler());
+
+	EXPECT_NO_THROW(other.StartProfiler());
+	static_cast< void >(other.StopProfiler());
+}
+
+class UnitScript_LazyLibraries : public UnitScript
+{
+protected:
+	struct Counter
+	{
+		int32_t value = 3;
+	};
+};
+
+TEST_F(UnitScript_LazyLibraries, ShouldOpenLibrariesOnFirstUse)
+{
+	Script::Engine lazy{ Script::EngineOptions{ .libraries = Script::Library::Table | Script::Library::Math | Script::Library::String, .lazyLibraries = true } };
+
+	EXPECT_TRUE(lazy.Execute(R"(return rawget(_G, "math") == nil)").Get< bool >());
+	EXPECT_TRUE(lazy.Execute(R"(return rawget(_G, "string") ~= nil)").Get< bool >());
+	EXPECT_EQ(lazy.Execute(R"(return math.max(1, 2))").Get< int32_t >(), 2);
+	EXPECT_EQ(lazy.Execute(R"(return table.concat({ "a", "b" }))").Get< std::string >(), "ab");
+	EXPECT_TRUE(lazy.Execute(R"(return io == nil and os == nil and getmetatable(_G) == nil)").Get< bool >());
+
+	Script::Engine minimal{ Script::EngineOptions{ .libraries = Script::Library::None } };
+	EXPECT_EQ(minimal.Execute(R"(return tostring(1) .. type(print))").Get< std::string >(), "1function");
+	EXPECT_TRUE(minimal.Execute(R"(return require == nil and string == nil)").Get< bool >());
+}
+
+TEST_F(UnitScript_LazyLibraries, ShouldRegisterDeferredMetatableOnDemand)
+{
+	int32_t registrations = 0;
+	script.DeferMetatable(Script::Utils::DemangleClassName< Counter >(), [ &registrations ](const Script::Engine& engine) {
+		registrations++;
+		engine.GetMetatable(Script::Utils::DemangleClassName< Counter >())
+			->RegisterReferenceDestructor(&engine)
+			->SetProperty("value", &Counter::value);
+	});
+	EXPECT_EQ(registrations, 0);
+
+	script.SetGlobal("Variable", std::shared_ptr< Counter >{ new Counter{} });
+	EXPECT_EQ(script.Execute(R"(return Variable.value)").Get< int32_t >(), 3);
+	EXPECT_EQ(registrations, 1);
+
+	script.DeferMetatable("LazyGlobal", [ &registrations ](const Script::Engine& engine) {
+		registrations++;
+		engine.GetMetatable("LazyGlobal")->SetField("Name", std::function{ []() -> std::string { return "LazyGlobal"; } });
+	});
+	EXPECT_EQ(script.Execute(R"(return LazyGlobal.Name())").Get< std::string >(), "LazyGlobal");
+	EXPECT_EQ(script.Execute(R"(return LazyGlobal.Name())").Get< std::string >(), "LazyGlobal");
+	EXPECT_EQ(registrations, 2);
+	EXPECT_TRUE(script.Execute(R"(return getmetatable(_G) == nil)").Get< bool >());
+
+	script.RemoveGlobal("Variable");
+}
+
+class UnitScript_EngineFactory : public UnitScript
+{
+protected:
+	void SetUp() override
+	{
+		factory.AddBinding([](Script::Engine& engine) {
+			engine.GetMetatable("Factory")->SetField("Name", std::function{ []() -> std::string { return "Factory"; } });
+		});
+		factory.AddChunk("Init", "Counter = 0; function Increment() Counter = Counter + 1; return Counter; end");
+		factory.AddChunk("Sandboxed", "Variable = Factory.Name()", "Sandbox");
+	}
+
+	Script::EngineFactory factory;
+};
+
+TEST_F(UnitScript_EngineFactory, ShouldReplayManifest)
+{
+	const Script::EnginePtr first = factory.Create();
+	const Script::EnginePtr second = factory.Create();
+
+	EXPECT_EQ(first->Execute(R"(return Increment())").Get< int32_t >(), 1);
+	EXPECT_EQ(first->Execute(R"(return Increment())").Get< int32_t >(), 2);
+	EXPECT_EQ(second->Execute(R"(return Increment())").Get< int32_t >(), 1);
+	EXPECT_EQ(second->Execute(R"(return Sandbox.Variable)").Get< std::string >(), "Factory");
+	EXPECT_TRUE(second->Execute(R"(return Variable == nil)").Get< bool >());
+
+	EXPECT_THROW(factory.AddChunk("Broken", "local = 1"), std::string);
+	factory.AddChunk("Failing", "error('Failing')");
+	EXPECT_THROW(static_cast< void >(factory.Create()), std::string);
+}
+
+TEST_F(UnitScript_EngineFactory, ShouldHandOutPooledEngines)
+{
+	factory.StartPool(2);
+	EXPECT_THROW(factory.AddChunk("Late", "return"), std::string);
+
+	for (int32_t i = 0; i < 1000 && factory.GetPooled() < 2; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+	}
+	EXPECT_EQ(factory.GetPooled(), size_t{ 2 });
+
+	const Script::EnginePtr engine = factory.Acquire();
+	EXPECT_EQ(engine->Execute(R"(return Factory.Name() .. Increment())").Get< std::string >(), "Factory1");
+
+	factory.StopPool();
+	EXPECT_EQ(factory.GetPooled(), size_t{ 0 });
+	EXPECT_EQ(factory.Acquire()->Execute(R"(return Increment())").Get< int32_t >(), 1);
+}
+
+TEST_F(UnitScript_EngineFactory, ShouldReportPoolErrors)
+{
+	struct Base
+	{ };
+	struct Derived : Base
+	{ };
+
+	factory.AddChunk("Failing", "error('Failing')");
+	factory.StartPool(1);
+	EXPECT_THROW((factory.AddType< Derived, Base >()), std::string);
+
+	bool failed = false;
+	for (int32_t i = 0; i < 1000 && !failed; ++i) {
+		try {
+			static_cast< void >(factory.GetPooled());
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+		} catch (const std::string& error) {
+			EXPECT_NE(error.find("Failing"), std::string::npos);
+			failed = true;
+		}
+	}
+	EXPECT_TRUE(failed);
+	EXPECT_THROW(static_cast< void >(factory.Acquire()), std::string);
+
+	factory.StopPool();
+	EXPECT_EQ(factory.GetPooled(), size_t{ 0 });
+	EXPECT_NO_THROW((factory.AddType< Derived, Base >()));
+}
+
+struct Unpushable
+{ };
+
+namespace Script
+{
+
+template <>
+struct Stack< Unpushable >
+{
+	static void Push(lua_State*, const Unpushable&) { throw std::string{ "<Unpushable> Can't be pushed" }; }
+};
+
+} // namespace Script
+
+class UnitScript_CallBatch : public UnitScript
+{
+protected:
+	void SetUp() override
+	{
+		ASSERT_TRUE(script.ExecuteRaw(R"(
+			function Add(left, right)
+				if left < 0 then error("negative") end
+				return left + right;
+			end
+			Total = 0;
+			function Accumulate(value) Total = Total + value; end
+		)"));
+	}
+};
+
+TEST_F(UnitScript_CallBatch, ShouldCallFunctionForEachArgumentSet)
+{
+	const std::vector< std::tuple< int32_t, int32_t > > arguments = { { 1, 2 }, { 3, 4 }, { 5, 6 } };
+	std::vector< int32_t > results(arguments.size());
+
+	const Script::BatchResult result = script.GetGlobal("Add").CallBatch(arguments, results);
+	EXPECT_EQ(result.calls, size_t{ 3 });
+	EXPECT_EQ(result.failed, size_t{ 0 });
+	EXPECT_THAT(results, ElementsAre(3, 7, 11));
+
+	const std::vector< int32_t > values = { 1, 2, 3, 4 };
+	EXPECT_EQ(script.GetGlobal("Accumulate").CallBatch(values).calls, size_t{ 4 });
+	EXPECT_EQ(script.GetGlobal("Total").Get< int32_t >(), 10);
+
+	EXPECT_THROW(static_cast< void >(script.GetGlobal("Total").CallBatch(values)), std::string);
+}
+
+TEST_F(UnitScript_CallBatch, ShouldApplyErrorPolicy)
+{
+	const std::vector< std::tuple< int32_t, int32_t > > arguments = { { 1, 1 }, { -1, 1 }, { 2, 2 }, { -2, 2 } };
+	std::vector< int32_t > results(arguments.size(), -1);
+	const Script::Reference function = script.GetGlobal("Add");
+
+	const Script::BatchResult stopped = function.CallBatch(arguments, results, Script::BatchPolicy::Stop);
+	EXPECT_EQ(stopped.calls, size_t{ 2 });
+	ASSERT_EQ(stopped.errors.size(), size_t{ 1 });
+	EXPECT_EQ(stopped.errors[ 0 ].index, size_t{ 1 });
+	EXPECT_THAT(stopped.errors[ 0 ].message, HasSubstr("negative"));
+	EXPECT_THAT(results, ElementsAre(2, -1, -1, -1));
+
+	const Script::BatchResult skipped = function.CallBatch(arguments, results, Script::BatchPolicy::Skip);
+	EXPECT_EQ(skipped.calls, size_t{ 4 });
+	EXPECT_EQ(skipped.failed, size_t{ 2 });
+	EXPECT_TRUE(skipped.errors.empty());
+	EXPECT_THAT(results, ElementsAre(2, -1, 4, -1));
+
+	const Script::BatchResult collected = function.CallBatch(arguments, results, Script::BatchPolicy::Collect);
+	ASSERT_EQ(collected.errors.size(), size_t{ 2 });
+	EXPECT_EQ(collected.errors[ 1 ].index, size_t{ 3 });
+}
+
+TEST_F(UnitScript_CallBatch, ShouldCallObjectsWithCallMetamethod)
+{
+	const std::vector< std::tuple< int32_t, int32_t > > arguments = { { 1, 2 }, { 3, 4 } };
+
+	script.SetGlobal("Multiply", std::function{ [](const int32_t left, const int32_t right) { return left * right; } });
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		Offset = setmetatable({ value = 10 }, { __call = function(self, left, right) return self.value + left + right; end });
+	)"));
+
+	for (const Script::BatchPolicy policy : { Script::BatchPolicy::Stop, Script::BatchPolicy::Skip }) {
+		std::vector< int32_t > results(arguments.size());
+		EXPECT_EQ(script.GetGlobal("Multiply").CallBatch(arguments, results, policy).failed, size_t{ 0 });
+		EXPECT_THAT(results, ElementsAre(2, 12));
+
+		EXPECT_EQ(script.GetGlobal("Offset").CallBatch(arguments, results, policy).failed, size_t{ 0 });
+		EXPECT_THAT(results, ElementsAre(13, 17));
+	}
+
+	script.RemoveGlobal("Multiply");
+}
+
+TEST_F(UnitScript_CallBatch, ShouldStopUnderOneProtectedCall)
+{
+	const std::vector< int32_t > values = { 1, 2, 3, 4 };
+	const Script::Reference function = script.GetGlobal("Accumulate");
+
+	const uint64_t calls = script.Metrics().protectedCalls;
+	EXPECT_EQ(function.CallBatch(values).calls, size_t{ 4 });
+	EXPECT_EQ(script.Metrics().protectedCalls, calls + 1);
+	EXPECT_EQ(script.GetGlobal("Total").Get< int32_t >(), 10);
+	EXPECT_EQ(function.CallBatch(values, Script::BatchPolicy::Skip).calls, size_t{ 4 });
+	EXPECT_EQ(script.Metrics().protectedCalls, calls + 5);
+
+	const std::vector< Unpushable > unpushable(2);
+	for (const Script::BatchPolicy policy : { Script::BatchPolicy::Stop, Script::BatchPolicy::Skip, Script::BatchPolicy::Collect }) {
+		EXPECT_THROW(static_cast< void >(function.CallBatch(unpushable, policy)), std::string);
+		EXPECT_TRUE(script.IsStackTop());
+	}
+}
+
+class UnitScript_EventBus : public UnitScript
+{
+protected:
+	Script::EventBusPtr bus = script.GetEventBus();
+};
+
+TEST_F(UnitScript_EventBus, ShouldDispatchByPriority)
+{
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		Calls = "";
+		EventBus.On("Tick", function(value) Calls = Calls .. "a" .. value; end);
+		EventBus.On("Tick", function(value) Calls = Calls .. "b" .. value; end, 10);
+		EventBus.Once("Tick", function(value) Calls = Calls .. "c" .. value; end, 5);
+	)"));
+
+	const Script::EventBus::EventId tick = bus->GetEventId("Tick");
+	EXPECT_EQ(bus->Emit(tick, 1), size_t{ 3 });
+	EXPECT_EQ(bus->Emit("Tick", 2), size_t{ 2 });
+	EXPECT_EQ(bus->Emit("Unknown", 3), size_t{ 0 });
+	EXPECT_EQ(script.GetGlobal("Calls").Get< std::string >(), "b1c1a1b2a2");
+
+	const Script::EventBus::HandlerId handler = bus->On(tick, script.Execute(R"(return function() Calls = "" end)"), 20);
+	EXPECT_EQ(script.Execute(R"(return EventBus.Emit("Tick", 3))").Get< int32_t >(), 3);
+	EXPECT_EQ(script.GetGlobal("Calls").Get< std::string >(), "b3a3");
+	EXPECT_TRUE(bus->Off(handler));
+	EXPECT_FALSE(bus->Off(handler));
+	EXPECT_EQ(bus->GetHandlerCount(tick), size_t{ 2 });
+}
+
+TEST_F(UnitScript_EventBus, ShouldChangeHandlersDuringDispatch)
+{
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		Calls = "";
+		local second = nil;
+		EventBus.On("Tick", function()
+			Calls = Calls .. "a";
+			EventBus.Off(second);
+			EventBus.On("Tick", function() Calls = Calls .. "c"; end, 10);
+		end, 20);
+		second = EventBus.On("Tick", function() Calls = Calls .. "b"; end);
+		EventBus.On("Fail", function() error("Fail"); end);
+		EventBus.On("Fail", function() Calls = Calls .. "f"; end);
+	)"));
+
+	EXPECT_EQ(bus->Emit("Tick"), size_t{ 1 });
+	EXPECT_EQ(script.GetGlobal("Calls").Get< std::string >(), "a");
+	EXPECT_EQ(bus->GetHandlerCount(bus->GetEventId("Tick")), size_t{ 2 });
+
+	EXPECT_THROW(bus->Emit("Fail"), std::string);
+	EXPECT_FALSE(script.Execute(R"(return pcall(EventBus.Emit, "Fail"))").Get< bool >());
+
+	std::vector< std::string > errors = {};
+	bus->SetErrorCallback([ &errors ](const std::string& event, const std::string& error) { errors.push_back(event + ": " + error); });
+	EXPECT_EQ(bus->Emit("Fail"), size_t{ 2 });
+	ASSERT_EQ(errors.size(), size_t{ 1 });
+	EXPECT_THAT(errors[ 0 ], HasSubstr("Fail: "));
+	EXPECT_EQ(script.GetGlobal("Calls").Get< std::string >(), "afff");
+}
+
+TEST_F(UnitScript_EventBus, ShouldRecoverFromThrowingErrorCallback)
+{
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		Calls = "";
+		EventBus.On("Fail", function(value) Calls = Calls .. "a"; error("Fail"); end);
+	)"));
+
+	bus->SetErrorCallback([](const std::string&, const std::string& error) { throw error; });
+	EXPECT_THROW(bus->Emit("Fail", 1), std::string);
+	EXPECT_TRUE(script.IsStackTop());
+
+	// Handlers are sorted again once the event isn't dispatched anymore.
+	ASSERT_TRUE(script.ExecuteRaw(R"(EventBus.On("Fail", function() Calls = Calls .. "b"; end, 10))"));
+	bus->SetErrorCallback([](const std::string&, const std::string&) { });
+	EXPECT_EQ(bus->Emit("Fail", 2), size_t{ 2 });
+	EXPECT_EQ(script.GetGlobal("Calls").Get< std::string >(), "aba");
+}
+
+class UnitScript_Jit : public UnitScript
+{
+protected:
+	Script::JitControlPtr jit = script.Jit();
+};
+
+TEST_F(UnitScript_Jit, ShouldCountCompiledTraces)
+{
+	EXPECT_TRUE(jit->IsEnabled());
+	jit->SetParameter(Script::JitParameter::HotLoop, 2);
+	jit->SetOptimizationLevel(3);
+	jit->SetOptimization("fold", true);
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		function Sum(count)
+			local value = 0;
+			for i = 1, count do value = value + i; end
+			return value;
+		end
+	)"));
+	EXPECT_EQ(script.Execute(R"(return Sum(1000))").Get< int32_t >(), 500500);
+
+	Script::JitStatistics statistics = jit->GetStatistics();
+	EXPECT_GT(statistics.compiled, uint64_t{ 0 });
+	EXPECT_GT(statistics.traces, uint64_t{ 0 });
+	EXPECT_GT(statistics.mcodeBytes, uint64_t{ 0 });
+
+	jit->Flush();
+	statistics = jit->GetStatistics();
+	EXPECT_EQ(statistics.flushed, uint64_t{ 1 });
+	EXPECT_EQ(statistics.traces, uint64_t{ 0 });
+
+	EXPECT_THROW(jit->SetOptimization("unknown", true), std::string);
+	EXPECT_THROW(jit->SetOptimizationLevel(4), std::string);
+}
+
+TEST_F(UnitScript_Jit, ShouldDisableCompilerPerFunction)
+{
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		function Sum(count)
+			local value = 0;
+			for i = 1, count do value = value + i; end
+			return value;
+		end
+	)"));
+	jit->SetFunctionMode(script.GetGlobal("Sum"), false);
+	EXPECT_EQ(script.Execute(R"(return Sum(1000))").Get< int32_t >(), 500500);
+	EXPECT_EQ(jit->GetStatistics().compiled, uint64_t{ 0 });
+	EXPECT_THROW(jit->SetFunctionMode(script.GetGlobal("print"), false), std::string);
+
+	jit->SetEnabled(false);
+	EXPECT_FALSE(jit->IsEnabled());
+
+	Script::Engine other{ Script::EngineOptions{ .libraries = Script::Library::None } };
+	EXPECT_FALSE(other.Jit()->IsEnabled());
+	EXPECT_TRUE(other.Execute(R"(return jit == nil)").Get< bool >());
+}
+
+class UnitScript_TraceDiagnostics : public UnitScript
+{
+protected:
+	static auto Twice(const int32_t value) -> int32_t { return value * 2; }
+
+	Script::TraceDiagnosticsPtr diagnostics = script.CreateTraceDiagnostics();
+};
+
+TEST_F(UnitScript_TraceDiagnostics, ShouldAttributeAbortsToBindings)
+{
+	script.Jit()->SetParameter(Script::JitParameter::HotLoop, 1);
+	script.Jit()->SetParameter(Script::JitParameter::MinStitch, 1000);
+	script.SetGlobal("Twice", &Twice);
+	ASSERT_TRUE(script.ExecuteRaw(R"(
+		local value = 0;
+		for i = 1, 100 do
+			value = value + Twice(i);
+		end
+		for i = 1, 100 do
+			local ok, result = pcall(Twice, i);
+			value = value + result;
+		end
+	)"));
+
+	EXPECT_GT(diagnostics->GetAborts(), uint64_t{ 0 });
+	EXPECT_GT(diagnostics->GetBindingAborts(), uint64_t{ 0 });
+	EXPECT_LT(diagnostics->GetBindingAborts(), diagnostics->GetAborts());
+
+	const auto reasons = diagnostics->GetTopReasons(1);
+	ASSERT_EQ(reasons.size(), size_t{ 1 });
+	EXPECT_EQ(reasons[ 0 ].reason, "trace too short");
+
+	const auto sites = diagnostics->GetTopSites(10);
+	const auto binding = std::find_if(sites.begin(), sites.end(), [](const Script::TraceAbortSite& site) { return site.binding; });
+	ASSERT_NE(binding, sites.end());
+	EXPECT_EQ(binding->callee, "Twice");
+	EXPECT_THAT(binding->location, EndsWith(":4"));
+
+	diagnostics->Reset();
+	EXPECT_EQ(diagnostics->GetAborts(), uint64_t{ 0 });
+	EXPECT_TRUE(diagnostics->GetTopSites(10).empty());
+}
+
+TEST_F(UnitScript_TraceDiagnostics, ShouldDescribeErrorCodes)
+{
+	EXPECT_EQ(Script::TraceDiagnostics::GetErrorMessage(1), "trace too short");
+	EXPECT_EQ(Script::TraceDiagnostics::GetErrorMessage(27), "failed to allocate mcode memory");
+	EXPECT_TRUE(Script::TraceDiagnostics::GetErrorMessage(-1).empty());
+	EXPECT_TRUE(Script::TraceDiagnostics::GetErrorMessage(1000).empty());
+}
+
+class UnitScript_Metrics : public UnitScript_SharedClass
+{
+};
+
+TEST_F(UnitScript_Metrics, ShouldCountRuntime)
+{
+	const std::string BaseMetatable = Script::Utils::DemangleClassName< BaseClass >();
+	lua_State* L = script.State();
+
+	const Script::EngineMetrics before = script.Metrics();
+	EXPECT_GT(before.heapBytes, uint64_t{ 0 });
+	EXPECT_TRUE(before.objects.empty());
+	EXPECT_FALSE(before.jit.has_value());
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(Objects = { BaseClass.Create("a"), BaseClass.Create("b") })"));
+	EXPECT_THROW(static_cast< void >(script.ExecuteRaw(R"(error("failed"))")), std::string);
+	// The error message is left on the stack.
+	lua_pop(L, 1);
+	script.SetGlobal("Bound", std::function{ [](const int32_t value) { return value; } });
+	lua_newtable(L);
+	const int32_t weak = Script::Utils::WeakRefSet(L);
+	script.CollectGarbage();
+
+	{
+		const Script::Reference objects = script.GetGlobal("Objects");
+		const Script::EngineMetrics metrics = script.Metrics();
+		EXPECT_EQ(metrics.objects.at(BaseMetatable), uint64_t{ 2 });
+		EXPECT_EQ(metrics.strongReferences, before.strongReferences + 1);
+		// The table was only weakly referenced, the collection dropped it.
+		EXPECT_EQ(metrics.weakReferences, before.weakReferences);
+		EXPECT_EQ(metrics.boundFunctions, before.boundFunctions + 1);
+		EXPECT_EQ(metrics.protectedCalls, before.protectedCalls + 2);
+		EXPECT_EQ(metrics.errors, before.errors + 1);
+		EXPECT_GT(metrics.gcCycles, before.gcCycles);
+	}
+	Script::Utils::WeakUnref(L, weak);
+
+	script.GetGlobal().Push();
+	const int32_t weakGlobals = Script::Utils::WeakRefSet(L);
+	EXPECT_EQ(script.Metrics().weakReferences, before.weakReferences + 1);
+	Script::Utils::WeakUnref(L, weakGlobals);
+
+	ASSERT_TRUE(script.ExecuteRaw(R"(Objects = nil)"));
+	script.RemoveGlobal("Bound");
+	script.CollectGarbage();
+
+	const Script::EngineMetrics after = script.Metrics();
+	EXPECT_FALSE(after.objects.contains(BaseMetatable));
+	EXPECT_EQ(after.strongReferences, before.strongReferences);
+	EXPECT_EQ(after.weakReferences, before.weakReferences);
+	EXPECT_EQ(after.boundFunctions, before.boundFunctions);
+
+	static_cast< void >(script.Jit());
+	EXPECT_TRUE(script.Metrics().jit.has_value());
+}
+
+TEST(UnitScript_MetricsExporter, ShouldRenderPool)
+{
+	Script::EngineMetrics first = {
+		.heapBytes = 2048,
+		.objects = { { "Player", 3 } },
+		.errors = 1,
+	};
+	Script::EngineMetrics second = {
+		.heapBytes = 1024,
+		.jit = Script::JitStatistics{ .compiled = 7 },
+	};
+	const Script::MetricsExporter::Pool pool = { { "first", first }, { "sec\"ond", second } };
+
+	const std::string json = Script::MetricsExporter::ToJson(pool);
+	EXPECT_THAT(json, StartsWith(R"({"engines":[{"name":"first","heapBytes":2048,)"));
+	EXPECT_THAT(json, HasSubstr(R"("errors":1,)"));
+	EXPECT_THAT(json, HasSubstr(R"("objects":{"Player":3}})"));
+	EXPECT_THAT(json, HasSubstr(R"({"name":"sec\"ond","heapBytes":1024,)"));
+	EXPECT_THAT(json, HasSubstr(R"("objects":{},"jit":{"started":0,"compiled":7,)"));
+	EXPECT_THAT(json, EndsWith("}}]}"));
+
+	const std::string text = Script::MetricsExporter::ToPrometheus(pool, "game");
+	EXPECT_THAT(text, HasSubstr("# TYPE game_heap_bytes gauge\ngame_heap_bytes{engine=\"first\"} 2048\ngame_heap_bytes{engine=\"sec\\\"ond\"} 1024\n"));
+	EXPECT_THAT(text, HasSubstr("# TYPE game_errors_total counter\n"));
+	EXPECT_THAT(text, HasSubstr("game_objects{engine=\"first\",metatable=\"Player\"} 3\n"));
+	EXPECT_THAT(text, HasSubstr("game_jit_traces_compiled_total{engine=\"sec\\\"ond\"} 7\n"));
+	EXPECT_THAT(text, Not(HasSubstr("game_jit_traces_compiled_total{engine=\"first\"}")));
+}
@@ -0,0 +1,31 @@
+#include <Framework/Script/Bundle.hpp>
+
+#include <iostream>
+
+// Usage: ScriptBundle <directory> <output> [--bytecode]
+int main(int argc, char* argv[])
+{
+	if (argc < 3 || argc > 4 || (argc == 4 && std::string{ argv[ 3 ] } != "--bytecode")) {
+		std::cerr << "Usage: " << argv[ 0 ] << " <directory> <output> [--bytecode]" << std::endl;
+		return 1;
+	}
+
+	try {
+		Script::BundleBuilder builder;
+		builder.AddDirectory(argv[ 1 ]);
+		if (argc == 4) {
+			builder.Compile();
+		}
+		builder.Write(argv[ 2 ]);
+
+		std::cout << "Bundled " << builder.GetModules().size() << " modules into " << argv[ 2 ] << std::endl;
+	} catch (const std::string& error) {
+		std::cerr << error << std::endl;
+		return 1;
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}